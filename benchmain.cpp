@@ -0,0 +1,53 @@
+#include "configbench.h"
+#include <QCommandLineParser>
+#include <QFile>
+#include <QGuiApplication>
+#include <QTextStream>
+
+// dsq_bench: runs ConfigBench and prints JSON, or CSV when --output ends in .csv.
+int main(int argc, char *argv[])
+{
+    // The highlighter cases need a QGuiApplication but never a window.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Micro-benchmarks for the DemulEASY config hot paths.");
+    parser.addHelpOption();
+    QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains <text>.", "text");
+    QCommandLineOption timeOption("time", "Minimum time per benchmark in milliseconds.", "ms", "200");
+    QCommandLineOption outputOption("output", "Write results to <file> (.csv for CSV, JSON otherwise).", "file");
+    parser.addOptions({filterOption, timeOption, outputOption});
+    parser.process(app);
+
+    const QString filter = parser.value(filterOption);
+    ConfigBench bench(parser.value(timeOption).toInt());
+    const QList<ConfigBench::Result> results = bench.run(filter);
+    if (results.isEmpty()) {
+        err << "No benchmark matches \"" << filter << "\"\n";
+        return 2;
+    }
+
+    const QString outputPath = parser.value(outputOption);
+    const bool csv = outputPath.endsWith(".csv", Qt::CaseInsensitive);
+    const QByteArray report = csv ? ConfigBench::toCsv(results) : ConfigBench::toJson(results);
+
+    if (outputPath.isEmpty()) {
+        out << report;
+        return 0;
+    }
+
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        err << "Cannot write " << outputPath << '\n';
+        return 1;
+    }
+    file.write(report);
+
+    for (const ConfigBench::Result &result : results)
+        out << result.name << '\t' << QString::number(result.nsPerIteration(), 'f', 0) << " ns\n";
+    return 0;
+}
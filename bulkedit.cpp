@@ -0,0 +1,124 @@
+#include "bulkedit.h"
+#include "dsqlogging.h"
+#include "dsqtrace.h"
+#include "emulatorutils.h"
+#include "linediff.h"
+#include "openfireflags.h"
+#include "textfile.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QVector>
+
+QString BulkEdit::transform(const QString &iniContent, const OpenFireSettings &changes)
+{
+    const OpenFireSettings before = OpenFireConfig::parse(iniContent);
+
+    // Only the start and mode flags go through apply(); with no outputs it
+    // leaves every player's output lines as they are
+    OpenFireSettings merged;
+    merged.playerCount = before.playerCount;
+    for (const OpenFireFlags::Family &family : OpenFireFlags::families()) {
+        const QString &changed = changes.*family.field;
+        merged.*family.field = changed.isEmpty() ? before.*family.field : changed;
+    }
+
+    QString result = iniContent;
+    // apply() rewrites MameStart and the mode lines; skip it when they stay the same
+    if (merged.startCommand != before.startCommand || merged.modeFlags() != before.modeFlags())
+        result = OpenFireConfig::apply(result, merged);
+
+    for (const auto &output : changes.outputs)
+        result = OpenFireConfig::setOutputForAllPlayers(result, output.first, output.second);
+
+    for (int player = 1; player <= merged.playerCount && player <= 4; ++player) {
+        if (changes.ledColors[player - 1].isValid())
+            result = OpenFireConfig::setLmpStart(result, player, changes.ledColors[player - 1]);
+    }
+    return result;
+}
+
+static void countLineChanges(BulkEdit::FileChange &file)
+{
+    const LineDiff::Counts counts = LineDiff::count(file.original, file.updated);
+    file.linesAdded = counts.added;
+    file.linesRemoved = counts.removed;
+}
+
+QList<BulkEdit::FileChange> BulkEdit::preview(const QString &iniDir, const OpenFireSettings &changes)
+{
+    return preview(iniDir, [&changes](const QString &) { return changes; });
+}
+
+QList<BulkEdit::FileChange> BulkEdit::preview(const QString &iniDir,
+                                              const std::function<OpenFireSettings(const QString &romCode)> &changesFor)
+{
+    DSQ_TRACE_SPAN("BulkEdit::preview");
+    const QDir dir(iniDir);
+    const QStringList names = dir.entryList({"*.ini"}, QDir::Files, QDir::Name);
+
+    QList<FileChange> files;
+    files.reserve(names.size());
+    for (const QString &name : names) {
+        FileChange file;
+        file.path = dir.filePath(name);
+        files.append(file);
+    }
+
+    // Each task owns one slot, so no locking is needed
+    QThreadPool pool;
+    for (int i = 0; i < files.size(); ++i) {
+        FileChange *file = &files[i];
+        pool.start([file, &changesFor]() {
+            file->original = EmulatorUtils::loadIniContent(file->path);
+            file->updated = transform(file->original, changesFor(QFileInfo(file->path).completeBaseName()));
+            countLineChanges(*file);
+        });
+    }
+    pool.waitForDone();
+    return files;
+}
+
+QStringList BulkEdit::commit(const QList<FileChange> &files)
+{
+    DSQ_TRACE_SPAN("BulkEdit::commit");
+    QVector<bool> failed(files.size(), false);
+
+    QThreadPool pool;
+    for (int i = 0; i < files.size(); ++i) {
+        if (!files[i].changed())
+            continue;
+        const FileChange *file = &files[i];
+        bool *result = &failed[i];
+        pool.start([file, result]() {
+            // Leave files alone that someone else edited since the preview
+            if (EmulatorUtils::loadIniContent(file->path) != file->original) {
+                *result = true;
+                return;
+            }
+            *result = !TextFile::write(file->path, file->updated);
+        });
+    }
+    pool.waitForDone();
+
+    QStringList failures;
+    for (int i = 0; i < files.size(); ++i) {
+        if (failed[i]) {
+            qCWarning(lcExport) << "Bulk edit skipped or failed:" << files[i].path;
+            failures << files[i].path;
+        }
+    }
+    return failures;
+}
+
+QString BulkEdit::summary(const QList<FileChange> &files)
+{
+    QStringList lines;
+    for (const FileChange &file : files) {
+        if (file.changed())
+            lines << QString("%1: +%2 -%3").arg(QFileInfo(file.path).fileName())
+                         .arg(file.linesAdded).arg(file.linesRemoved);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,46 @@
+#ifndef BULKEDIT_H
+#define BULKEDIT_H
+
+#include "openfireconfig.h"
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+// Applies one set of OpenFIRE changes to every ini in a QMamehook ini
+// folder. preview() reads and transforms all files in parallel without
+// writing anything; commit() then writes the previewed results, each file
+// atomically and in its original encoding and line endings, skipping any
+// file that changed on disk in the meantime.
+class BulkEdit
+{
+public:
+    struct FileChange
+    {
+        QString path;
+        QString original;
+        QString updated;
+        int linesAdded = 0;
+        int linesRemoved = 0;
+        bool changed() const { return original != updated; }
+    };
+
+    // Only the set parts of changes are applied: a non-empty start command
+    // or mode flag, each entry in outputs (for players that already have that
+    // key) and each valid LED colour (for players the game has).
+    static QString transform(const QString &iniContent, const OpenFireSettings &changes);
+
+    static QList<FileChange> preview(const QString &iniDir, const OpenFireSettings &changes);
+    // As above with the changes chosen per file, by ROM code (the ini's base
+    // name). changesFor is called from the worker threads.
+    static QList<FileChange> preview(const QString &iniDir,
+                                     const std::function<OpenFireSettings(const QString &romCode)> &changesFor);
+
+    // Returns the paths that could not be written.
+    static QStringList commit(const QList<FileChange> &files);
+
+    // One line per changed file: "<name>: +<added> -<removed>".
+    static QString summary(const QList<FileChange> &files);
+};
+
+#endif // BULKEDIT_H
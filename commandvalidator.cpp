@@ -0,0 +1,301 @@
+#include "commandvalidator.h"
+#include "dsqtrace.h"
+#include "textfile.h"
+#include <QStringList>
+
+// [General] keys whose values are command lists.
+static const char *const commandKeys[] = {"MameStart", "MameStop", "StateChange", "OnRotate", "OnPause"};
+
+struct Span
+{
+    int start;
+    int length;
+};
+
+// Runs of non-blank characters.
+static QList<Span> words(QStringView text)
+{
+    QList<Span> spans;
+    int i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && (text.at(i) == ' ' || text.at(i) == '\t'))
+            ++i;
+        const int start = i;
+        while (i < text.size() && text.at(i) != ' ' && text.at(i) != '\t')
+            ++i;
+        if (i > start)
+            spans.append({start, i - start});
+    }
+    return spans;
+}
+
+static bool isNumber(QStringView text)
+{
+    if (text.isEmpty())
+        return false;
+    for (const QChar ch : text) {
+        if (!ch.isDigit())
+            return false;
+    }
+    return true;
+}
+
+static void report(QList<CommandValidator::Problem> &problems, int column, int length, const QString &message)
+{
+    CommandValidator::Problem problem;
+    problem.column = column;
+    problem.length = qMax(1, length);
+    problem.message = message;
+    problems.append(problem);
+}
+
+QList<int> CommandValidator::openedPorts(QStringView value)
+{
+    QList<int> ports;
+    for (int i = 0; i + 3 <= value.size(); ++i) {
+        if (value.mid(i, 3) != QLatin1String("cmo") || (i > 0 && value.at(i - 1).isLetterOrNumber()))
+            continue;
+        const QList<Span> spans = words(value.mid(i + 3));
+        if (spans.isEmpty())
+            continue;
+        const QStringView port = value.mid(i + 3 + spans.first().start, spans.first().length);
+        if (isNumber(port))
+            ports.append(port.toString().toInt());
+    }
+    return ports;
+}
+
+void CommandValidator::validatePortSettings(QStringView settings, int offset, QList<Problem> &problems)
+{
+    // baud=9600_parity=N_data=8_stop=1, in that order
+    static const char *const keys[] = {"baud", "parity", "data", "stop"};
+    static const QStringList bauds = {"300", "600", "1200", "2400", "4800", "9600", "14400",
+                                      "19200", "38400", "57600", "115200"};
+    static const QStringList parities = {"N", "E", "O", "M", "S"};
+    static const QStringList dataBits = {"5", "6", "7", "8"};
+    static const QStringList stopBits = {"1", "1.5", "2"};
+    const QStringList *allowed[] = {&bauds, &parities, &dataBits, &stopBits};
+
+    int start = 0;
+    for (int part = 0; part < 4; ++part) {
+        const QString key = QLatin1String(keys[part]);
+        if (start > settings.size()) {
+            report(problems, offset + int(settings.size()) - 1, 1, QString("Missing %1= in the port settings").arg(key));
+            return;
+        }
+        int end = start;
+        while (end < settings.size() && settings.at(end) != '_')
+            ++end;
+        const QStringView field = settings.mid(start, end - start);
+        const int eq = int(field.indexOf(QLatin1Char('=')));
+        if (eq < 0 || field.left(eq) != key) {
+            report(problems, offset + start, int(field.size()), QString("Expected %1=<value> here").arg(key));
+            return;
+        }
+        const QString value = field.mid(eq + 1).toString();
+        if (!allowed[part]->contains(value)) {
+            report(problems, offset + start + eq + 1, value.size(),
+                   QString("%1 must be one of %2").arg(key, allowed[part]->join(", ")));
+        }
+        start = end + 1;
+    }
+    if (start <= settings.size())
+        report(problems, offset + start - 1, int(settings.size()) - start + 1, "Unexpected text after stop=");
+}
+
+void CommandValidator::validatePayload(QStringView payload, int offset, QList<Problem> &problems)
+{
+    // Fields joined by 'x': letters and digits, or a %s% placeholder
+    int start = 0;
+    while (start <= payload.size()) {
+        int end = start;
+        while (end < payload.size() && payload.at(end) != 'x')
+            ++end;
+        const QStringView field = payload.mid(start, end - start);
+        if (field.isEmpty()) {
+            report(problems, offset + qMin(start, int(payload.size()) - 1), 1, "Empty field in the payload (doubled or trailing 'x')");
+        } else if (field != QLatin1String("%s%")) {
+            for (int i = 0; i < field.size(); ++i) {
+                const QChar ch = field.at(i);
+                if (ch == '%') {
+                    report(problems, offset + start, int(field.size()), "Malformed placeholder; the value is written as %s%");
+                    break;
+                }
+                if (!ch.isLetterOrNumber()) {
+                    report(problems, offset + start + i, 1, QString("Unexpected '%1' in the payload").arg(ch));
+                    break;
+                }
+            }
+        }
+        start = end + 1;
+    }
+}
+
+void CommandValidator::validateCommand(QStringView command, int offset, const Context &context, QList<Problem> &problems)
+{
+    int begin = 0;
+    int end = int(command.size());
+    while (begin < end && command.at(begin).isSpace())
+        ++begin;
+    while (end > begin && command.at(end - 1).isSpace())
+        --end;
+    if (begin == end) {
+        report(problems, offset, 1, "Empty command");
+        return;
+    }
+    // "cmo 1 baud=..." is often quoted
+    if (end - begin >= 2 && command.at(begin) == '"' && command.at(end - 1) == '"') {
+        ++begin;
+        --end;
+    }
+    command = command.mid(begin, end - begin);
+    offset += begin;
+
+    const QList<Span> spans = words(command);
+    if (spans.isEmpty()) {
+        report(problems, offset, 1, "Empty command");
+        return;
+    }
+    auto word = [&](int index) { return command.mid(spans[index].start, spans[index].length); };
+    const QStringView name = word(0);
+    if (!name.startsWith(QLatin1String("cm")))
+        return;
+    const bool isOpen = name == QLatin1String("cmo");
+    const bool isWrite = name == QLatin1String("cmw");
+    const bool isClose = name == QLatin1String("cmc");
+    if (!isOpen && !isWrite && !isClose) {
+        report(problems, offset, int(name.size()), QString("Unknown command %1 (expected cmo, cmw or cmc)").arg(name.toString()));
+        return;
+    }
+
+    if (spans.size() < 2) {
+        report(problems, offset, int(name.size()), QString("%1 needs a port number").arg(name.toString()));
+        return;
+    }
+    const QStringView port = word(1);
+    if (!isNumber(port) || port.toString().toInt() < 1) {
+        report(problems, offset + spans[1].start, spans[1].length, "The port must be a number from 1");
+        return;
+    }
+    if (!isOpen && !context.openPorts.isEmpty() && !context.openPorts.contains(port.toString().toInt())) {
+        report(problems, offset + spans[1].start, spans[1].length,
+               QString("Port %1 is not opened by a cmo command in MameStart").arg(port.toString()));
+    }
+
+    const int expected = isClose ? 2 : 3;
+    if (spans.size() < expected) {
+        report(problems, offset, int(command.size()),
+               isOpen ? QString("cmo needs port settings, e.g. baud=9600_parity=N_data=8_stop=1")
+                      : QString("cmw needs a payload, e.g. F0x2x1"));
+        return;
+    }
+    if (spans.size() > expected) {
+        const int extra = spans[expected].start;
+        report(problems, offset + extra, int(command.size()) - extra, "Unexpected text after the command");
+    }
+    if (isOpen)
+        validatePortSettings(word(2), offset + spans[2].start, problems);
+    else if (isWrite)
+        validatePayload(word(2), offset + spans[2].start, problems);
+}
+
+void CommandValidator::validateValue(QStringView value, int offset, const Context &context, QList<Problem> &problems)
+{
+    if (value.trimmed().isEmpty())
+        return;
+
+    // Commands are separated by ',' and an output's states by '|', outside quotes
+    int start = 0;
+    int quote = -1;
+    for (int i = 0; i <= value.size(); ++i) {
+        if (i < value.size() && value.at(i) == '"') {
+            quote = quote < 0 ? i : -1;
+            continue;
+        }
+        if (i < value.size() && (quote >= 0 || (value.at(i) != ',' && value.at(i) != '|')))
+            continue;
+        if (i == value.size() && quote >= 0) {
+            report(problems, offset + quote, 1, "Missing closing quote");
+            return;
+        }
+        validateCommand(value.mid(start, i - start), offset + start, context, problems);
+        start = i + 1;
+    }
+}
+
+QList<CommandValidator::Problem> CommandValidator::validateLine(QStringView line, const Context &context)
+{
+    QList<Problem> problems;
+    const int eq = int(line.indexOf(QLatin1Char('=')));
+    if (eq < 0) {
+        if (context.section == QLatin1String("Output"))
+            report(problems, 0, int(line.size()), "Expected <output> = <commands>");
+        return problems;
+    }
+
+    const QStringView key = line.left(eq).trimmed();
+    if (context.section == QLatin1String("General")) {
+        bool isCommandKey = false;
+        for (const char *commandKey : commandKeys)
+            isCommandKey = isCommandKey || key == QLatin1String(commandKey);
+        if (!isCommandKey)
+            return problems;
+    }
+    validateValue(line.mid(eq + 1), eq + 1, context, problems);
+    return problems;
+}
+
+QList<CommandValidator::Problem> CommandValidator::validate(const QString &iniContent)
+{
+    DSQ_TRACE_SPAN("CommandValidator::validate");
+    Context context;
+    for (LineReader lines(iniContent); !lines.atEnd(); ) {
+        const QStringView line = lines.next().trimmed();
+        if (line.startsWith(QLatin1String("MameStart"))) {
+            const int eq = int(line.indexOf(QLatin1Char('=')));
+            if (eq >= 0 && line.left(eq).trimmed() == QLatin1String("MameStart")) {
+                context.openPorts = openedPorts(line.mid(eq + 1));
+                break;
+            }
+        }
+    }
+    // Any change to the open ports changes the result of every cmw/cmc line
+    QString portsKey;
+    for (int port : context.openPorts)
+        portsKey += QString::number(port) + ',';
+
+    QHash<QString, QList<Problem>> seen;
+    QList<Problem> problems;
+    parsedLines = 0;
+    int lineNumber = 0;
+    for (LineReader lines(iniContent); !lines.atEnd(); ++lineNumber) {
+        const QStringView line = lines.next();
+        const QStringView trimmed = line.trimmed();
+        if (trimmed.startsWith('[')) {
+            const int close = int(trimmed.indexOf(QLatin1Char(']')));
+            context.section = trimmed.mid(1, close < 0 ? -1 : close - 1).toString();
+            continue;
+        }
+        if (trimmed.isEmpty() || trimmed.startsWith(';')
+            || (context.section != QLatin1String("General") && context.section != QLatin1String("Output")))
+            continue;
+
+        const QString key = context.section + '\n' + portsKey + '\n' + line.toString();
+        auto cached = cache.constFind(key);
+        QList<Problem> lineProblems;
+        if (cached != cache.constEnd()) {
+            lineProblems = cached.value();
+        } else {
+            lineProblems = validateLine(line, context);
+            ++parsedLines;
+        }
+        seen.insert(key, lineProblems);
+        for (Problem problem : lineProblems) {
+            problem.line = lineNumber;
+            problems.append(problem);
+        }
+    }
+    // Only keep what the current document uses
+    cache = seen;
+    return problems;
+}
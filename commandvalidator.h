@@ -0,0 +1,56 @@
+#ifndef COMMANDVALIDATOR_H
+#define COMMANDVALIDATOR_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringView>
+
+// Checks the QMamehook serial commands in an ini: the MameStart/MameStop
+// style lines in [General] and every [Output] value. A value is a list of
+// commands separated by ',' (and by '|' between an output's states), each
+// one of
+//   cmo <port> baud=<rate>_parity=<N|E|O|M|S>_data=<5-8>_stop=<1|1.5|2>
+//   cmw <port> <payload>      payload: fields joined by 'x', e.g. F0x2x1, DFAx%s%
+//   cmc <port>
+// A cmw/cmc port must be one MameStart opens with cmo. Other command
+// families are left alone.
+//
+// validate() remembers each line's result, keyed by the line, its section
+// and the open ports, so on the next call only edited lines are parsed
+// again. Not thread-safe; use an instance from one thread at a time.
+class CommandValidator
+{
+public:
+    struct Problem
+    {
+        int line = 0;
+        int column = 0;
+        int length = 0;
+        QString message;
+    };
+
+    QList<Problem> validate(const QString &iniContent);
+
+    // Lines actually parsed by the last validate() call.
+    int lastParsedLines() const { return parsedLines; }
+
+private:
+    struct Context
+    {
+        QString section;
+        QList<int> openPorts; // empty when there is no MameStart to check against
+    };
+
+    static QList<int> openedPorts(QStringView mameStartValue);
+    static QList<Problem> validateLine(QStringView line, const Context &context);
+    static void validateValue(QStringView value, int offset, const Context &context, QList<Problem> &problems);
+    static void validateCommand(QStringView command, int offset, const Context &context, QList<Problem> &problems);
+    static void validatePayload(QStringView payload, int offset, QList<Problem> &problems);
+    static void validatePortSettings(QStringView settings, int offset, QList<Problem> &problems);
+
+    QHash<QString, QList<Problem>> cache;
+    int parsedLines = 0;
+};
+
+#endif // COMMANDVALIDATOR_H
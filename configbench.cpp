@@ -0,0 +1,247 @@
+#include "configbench.h"
+#include "commandvalidator.h"
+#include "emulatorutils.h"
+#include "IniSyntaxHighlighter.h"
+#include "openfireconfig.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextDocument>
+
+// Results are folded into this so the optimizer cannot drop the work.
+static volatile qsizetype benchSink = 0;
+
+ConfigBench::ConfigBench(int minimumTimeMs)
+    : minimumTimeMs(qMax(1, minimumTimeMs))
+{
+}
+
+QList<ConfigBench::Result> ConfigBench::run(const QString &filter)
+{
+    this->filter = filter;
+    results.clear();
+
+    benchCatalog();
+    benchBatGeneration();
+    benchIni();
+    benchHighlighter();
+
+    return results;
+}
+
+void ConfigBench::measure(const QString &name, const std::function<void()> &body)
+{
+    if (!filter.isEmpty() && !name.contains(filter, Qt::CaseInsensitive))
+        return;
+
+    // One untimed warm-up pass fills static tables and caches.
+    body();
+
+    Result result;
+    result.name = name;
+    QElapsedTimer timer;
+    timer.start();
+    qint64 batch = 1;
+    while (timer.elapsed() < minimumTimeMs) {
+        for (qint64 i = 0; i < batch; ++i)
+            body();
+        result.iterations += batch;
+        batch *= 2;
+    }
+    result.totalNs = timer.nsecsElapsed();
+    results.append(result);
+}
+
+void ConfigBench::benchCatalog()
+{
+    QStringList games;
+    for (const QString &emulator : EmulatorUtils::emulatorList()) {
+        if (!EmulatorUtils::isDivider(emulator))
+            games += EmulatorUtils::gamesForEmulator(emulator);
+    }
+
+    QStringList unknownGames;
+    for (int i = 0; i < 64; ++i)
+        unknownGames << QString("Unlisted Game %1").arg(i);
+
+    measure("mapRom/hit", [&games]() {
+        for (const QString &game : games)
+            benchSink = benchSink + EmulatorUtils::mapRom(game).size();
+    });
+    measure("mapRom/fallback", [&unknownGames]() {
+        for (const QString &game : unknownGames)
+            benchSink = benchSink + EmulatorUtils::mapRom(game).size();
+    });
+
+    const QStringList emulators = EmulatorUtils::emulatorList();
+    measure("mapEmulator", [&emulators]() {
+        for (const QString &friendly : emulators) {
+            QString emulator = friendly;
+            QString demulShooterExe;
+            EmulatorUtils::mapEmulator(emulator, demulShooterExe);
+            benchSink = benchSink + emulator.size();
+        }
+    });
+}
+
+void ConfigBench::benchBatGeneration()
+{
+    // One emulator per launch style in generateBatContent.
+    const QList<QPair<QString, QString>> styles = {
+        {"demul07a",    "Demul 0.7a"},
+        {"flycast",     "Flycast v2.0"},
+        {"teknoparrot", "TeknoParrot Loader (Lindbergh)"},
+        {"default",     "Model2 Emulator v1.1a"},
+    };
+
+    QTemporaryDir hookDir;
+    for (const auto &style : styles) {
+        const QString emulator = style.second;
+        const QString game = EmulatorUtils::gamesForEmulator(emulator).value(0);
+        QString emulatorPath, romPath;
+        EmulatorUtils::updateEmulatorPath(emulator, emulatorPath, romPath);
+        const QString hookPath = hookDir.path();
+
+        measure("generateBatContent/" + style.first, [=]() {
+            benchSink = benchSink + EmulatorUtils::generateBatContent(game, emulator, emulatorPath, romPath,
+                                                                      hookPath, "C:/DemulShooter",
+                                                                      "-v", "-noresize").size();
+        });
+    }
+}
+
+QString ConfigBench::syntheticIni(int players, int extraLines)
+{
+    QStringList starts;
+    for (int player = 1; player <= players; ++player)
+        starts << QString("\"cmo %1 baud=9600_parity=N_data=8_stop=1\"").arg(player);
+    for (int player = 1; player <= players; ++player)
+        starts << QString("cmw %1 S6xM0x1xM1x2xMDx3B").arg(player);
+
+    QStringList lines;
+    lines << "[General]"
+          << "MameStart=" + starts.join(", ")
+          << "MameStop=cmw 1 E, cmc 1"
+          << "StateChange="
+          << "OnRotate="
+          << "OnPause="
+          << ""
+          << "[KeyStates]"
+          << "RefreshTime="
+          << ""
+          << "[Output]"
+          << "Credits = cmw 1 XX";
+    for (int player = 1; player <= players; ++player) {
+        lines << QString("P%1_CtmRecoil = cmw %1 F0x2x1").arg(player)
+              << QString("P%1_Damaged = cmw %1 F1x2x1").arg(player)
+              << QString("P%1_Clip = cmw %1 XX").arg(player)
+              << QString("P%1_Ammo = cmw %1 DFAx%s%").arg(player)
+              << QString("P%1_Life = cmw %1 DFLx%s%").arg(player)
+              << QString("P%1_LmpStart = cmw %1 F2x1x255xF3x1x0xF4x1x0 | cmw %1 F2x1x0xF3x1x0xF4x1x0").arg(player);
+    }
+    for (int i = 0; i < extraLines; ++i)
+        lines << QString("P%1_Custom%2 = cmw %1 F0x%s%").arg(i % qMax(1, players) + 1).arg(i);
+    return lines.join('\n') + '\n';
+}
+
+void ConfigBench::benchIni()
+{
+    QTemporaryDir dir;
+    const QString iniPath = QDir(dir.path()).filePath("bench.ini");
+    const QString content = syntheticIni(4, 0);
+    QFile file(iniPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        file.write(content.toUtf8());
+        file.close();
+    }
+
+    measure("ini/load", [&iniPath]() {
+        benchSink = benchSink + EmulatorUtils::loadIniContent(iniPath).size();
+    });
+    measure("ini/parse", [&content]() {
+        benchSink = benchSink + OpenFireConfig::parse(content).playerCount;
+    });
+
+    // A full check, and the re-check after a one-line edit that the editor does
+    const QString large = syntheticIni(4, 2000);
+    measure("ini/validate/full", [&large]() {
+        CommandValidator validator;
+        benchSink = benchSink + validator.validate(large).size();
+    });
+    const QString edited = large + "P1_Extra = cmw 1 F0x%s%\n";
+    CommandValidator incremental;
+    bool flip = false;
+    measure("ini/validate/one-line-edit", [&]() {
+        flip = !flip;
+        benchSink = benchSink + incremental.validate(flip ? edited : large).size();
+    });
+
+    for (int players = 1; players <= 4; ++players) {
+        const QString ini = syntheticIni(players, 0);
+        OpenFireSettings settings = OpenFireConfig::parse(ini);
+        settings.startCommand = "S4";
+        settings.displayMode = "MDx2";
+        settings.outputs = {
+            {"CtmRecoil", "F1x%s%"}, {"Damaged", "F1x%s%"}, {"Clip", "XX"},
+            {"Ammo", "DFAx%s%"}, {"Life", "DFLx%s%"}, {"Credits", "XX"}
+        };
+
+        measure(QString("ini/update/%1p").arg(players), [&ini, &settings]() {
+            benchSink = benchSink + OpenFireConfig::apply(ini, settings).size();
+        });
+    }
+}
+
+void ConfigBench::benchHighlighter()
+{
+    // Highlighting needs a QGuiApplication; dsq_bench creates one.
+    if (!QCoreApplication::instance() || !QCoreApplication::instance()->inherits("QGuiApplication"))
+        return;
+
+    for (int lineCount : {50, 1000, 10000, 100000}) {
+        QTextDocument document;
+        document.setPlainText(syntheticIni(4, qMax(0, lineCount - 36)));
+        IniSyntaxHighlighter highlighter(&document);
+
+        measure(QString("highlighter/%1-lines").arg(lineCount), [&highlighter, &document]() {
+            highlighter.rehighlight();
+            benchSink = benchSink + document.blockCount();
+        });
+    }
+}
+
+QByteArray ConfigBench::toJson(const QList<Result> &results)
+{
+    QJsonArray cases;
+    for (const Result &result : results) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["iterations"] = double(result.iterations);
+        entry["totalNs"] = double(result.totalNs);
+        entry["nsPerIteration"] = result.nsPerIteration();
+        cases.append(entry);
+    }
+
+    QJsonObject root;
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["results"] = cases;
+    return QJsonDocument(root).toJson();
+}
+
+QByteArray ConfigBench::toCsv(const QList<Result> &results)
+{
+    QByteArray csv = "name,iterations,total_ns,ns_per_iteration\n";
+    for (const Result &result : results) {
+        csv += result.name.toUtf8() + ',' + QByteArray::number(result.iterations) + ','
+               + QByteArray::number(result.totalNs) + ','
+               + QByteArray::number(result.nsPerIteration(), 'f', 1) + '\n';
+    }
+    return csv;
+}
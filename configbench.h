@@ -0,0 +1,49 @@
+#ifndef CONFIGBENCH_H
+#define CONFIGBENCH_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+
+// Micro-benchmarks for the config hot paths (catalog lookups, bat
+// generation, ini load/parse/update and syntax highlighting). Each case is
+// repeated until it has run for at least minimumTimeMs and reported as
+// nanoseconds per iteration, as JSON or CSV, so runs can be compared
+// across versions.
+class ConfigBench
+{
+public:
+    struct Result
+    {
+        QString name;
+        qint64 iterations = 0;
+        qint64 totalNs = 0;
+        double nsPerIteration() const { return iterations ? double(totalNs) / iterations : 0.0; }
+    };
+
+    explicit ConfigBench(int minimumTimeMs = 200);
+
+    // Runs every case whose name contains filter (all when empty).
+    QList<Result> run(const QString &filter = QString());
+
+    static QByteArray toJson(const QList<Result> &results);
+    static QByteArray toCsv(const QList<Result> &results);
+
+    // A representative OpenFIRE ini for the given player count, padded with
+    // extraLines custom output lines.
+    static QString syntheticIni(int players, int extraLines);
+
+private:
+    void measure(const QString &name, const std::function<void()> &body);
+
+    void benchCatalog();
+    void benchBatGeneration();
+    void benchIni();
+    void benchHighlighter();
+
+    int minimumTimeMs;
+    QString filter;
+    QList<Result> results;
+};
+
+#endif // CONFIGBENCH_H
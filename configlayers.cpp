@@ -0,0 +1,241 @@
+#include "configlayers.h"
+#include "dsqlogging.h"
+#include "dsqtrace.h"
+#include "emulatorutils.h"
+#include "openfireflags.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <algorithm>
+
+// Bump when the layer format changes so old files are not misread.
+static const int layersVersion = 1;
+
+ConfigLayers::ConfigLayers(const QString &settingsPath)
+    : filePath(QFileInfo(settingsPath).absoluteDir().filePath("layers.json"))
+{
+    // A game listed under several emulators takes the first one's layer
+    for (const QString &emulator : EmulatorUtils::emulatorList()) {
+        if (EmulatorUtils::isDivider(emulator))
+            continue;
+        for (const QString &game : EmulatorUtils::gamesForEmulator(emulator)) {
+            const QString romCode = EmulatorUtils::mapRom(game);
+            if (!romCode.isEmpty() && !emulatorForRom.contains(romCode))
+                emulatorForRom.insert(romCode, emulator);
+        }
+    }
+}
+
+void ConfigLayers::overlay(OpenFireSettings &target, const OpenFireSettings &over)
+{
+    if (!over.startCommand.isEmpty())
+        target.startCommand = over.startCommand;
+    for (const OpenFireFlags::Family *family : OpenFireFlags::modes()) {
+        if (!(over.*family->field).isEmpty())
+            target.*family->field = over.*family->field;
+    }
+
+    for (const auto &output : over.outputs) {
+        auto existing = std::find_if(target.outputs.begin(), target.outputs.end(),
+                                     [&output](const QPair<QString, QString> &entry) { return entry.first == output.first; });
+        if (existing != target.outputs.end())
+            existing->second = output.second;
+        else
+            target.outputs.append(output);
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        if (over.ledColors[i].isValid())
+            target.ledColors[i] = over.ledColors[i];
+    }
+}
+
+OpenFireSettings ConfigLayers::layer(Scope scope, const QString &name) const
+{
+    switch (scope) {
+    case Scope::Base:
+        return base;
+    case Scope::Emulator:
+        return emulators.value(name);
+    case Scope::Game:
+        return games.value(name);
+    }
+    return OpenFireSettings();
+}
+
+void ConfigLayers::mergeIntoLayer(Scope scope, const QString &name, const OpenFireSettings &settings)
+{
+    switch (scope) {
+    case Scope::Base:
+        overlay(base, settings);
+        break;
+    case Scope::Emulator:
+        overlay(emulators[name], settings);
+        break;
+    case Scope::Game:
+        overlay(games[name], settings);
+        break;
+    }
+}
+
+int ConfigLayers::unsetInLayer(Scope scope, const QString &name, const QStringList &keys)
+{
+    QHash<QString, OpenFireSettings> *layers = nullptr;
+    OpenFireSettings *settings = &base;
+    if (scope != Scope::Base) {
+        layers = scope == Scope::Emulator ? &emulators : &games;
+        auto layer = layers->find(name);
+        if (layer == layers->end())
+            return 0;
+        settings = &layer.value();
+    }
+
+    int removed = 0;
+    for (const QString &key : keys) {
+        if (key == QLatin1String("start")) {
+            removed += settings->startCommand.isEmpty() ? 0 : 1;
+            settings->startCommand.clear();
+        } else if (key.startsWith(QLatin1String("outputs/"))) {
+            const QString outputKey = key.mid(8);
+            const auto kept = std::remove_if(settings->outputs.begin(), settings->outputs.end(),
+                                             [&outputKey](const QPair<QString, QString> &entry) { return entry.first == outputKey; });
+            removed += int(settings->outputs.end() - kept);
+            settings->outputs.erase(kept, settings->outputs.end());
+        } else if (key.startsWith(QLatin1String("colors/"))) {
+            const int player = key.mid(7).toInt();
+            if (player >= 1 && player <= 4 && settings->ledColors[player - 1].isValid()) {
+                settings->ledColors[player - 1] = LedColor();
+                ++removed;
+            }
+        } else {
+            for (const OpenFireFlags::Family *family : OpenFireFlags::modes()) {
+                if (key == QLatin1String(family->key) && !(settings->*family->field).isEmpty()) {
+                    (settings->*family->field).clear();
+                    ++removed;
+                }
+            }
+        }
+    }
+
+    if (layers && toJson(*settings).isEmpty())
+        layers->remove(name);
+    return removed;
+}
+
+OpenFireSettings ConfigLayers::resolve(const QString &romCode) const
+{
+    OpenFireSettings resolved = base;
+    const auto emulator = emulatorForRom.constFind(romCode);
+    if (emulator != emulatorForRom.constEnd()) {
+        const auto layer = emulators.constFind(emulator.value());
+        if (layer != emulators.constEnd())
+            overlay(resolved, layer.value());
+    }
+    const auto game = games.constFind(romCode);
+    if (game != games.constEnd())
+        overlay(resolved, game.value());
+    return resolved;
+}
+
+QList<BulkEdit::FileChange> ConfigLayers::preview(const QString &iniDir) const
+{
+    DSQ_TRACE_SPAN("ConfigLayers::preview");
+    // resolve() only reads, so the workers can share this object
+    return BulkEdit::preview(iniDir, [this](const QString &romCode) { return resolve(romCode); });
+}
+
+QJsonObject ConfigLayers::toJson(const OpenFireSettings &settings)
+{
+    QJsonObject object;
+    if (!settings.startCommand.isEmpty())
+        object["start"] = settings.startCommand;
+    QJsonObject modes;
+    for (const OpenFireFlags::Family *family : OpenFireFlags::modes()) {
+        if (!(settings.*family->field).isEmpty())
+            modes[family->key] = settings.*family->field;
+    }
+    if (!modes.isEmpty())
+        object["modes"] = modes;
+    QJsonObject outputs;
+    for (const auto &output : settings.outputs)
+        outputs[output.first] = output.second;
+    if (!outputs.isEmpty())
+        object["outputs"] = outputs;
+    QJsonArray colors;
+    bool anyColor = false;
+    for (const LedColor &color : settings.ledColors) {
+        anyColor = anyColor || color.isValid();
+        colors.append(color.isValid() ? QJsonArray{color.red, color.green, color.blue} : QJsonArray());
+    }
+    if (anyColor)
+        object["colors"] = colors;
+    return object;
+}
+
+OpenFireSettings ConfigLayers::fromJson(const QJsonObject &object)
+{
+    OpenFireSettings settings;
+    settings.startCommand = object.value("start").toString();
+    const QJsonObject modes = object.value("modes").toObject();
+    for (const OpenFireFlags::Family *family : OpenFireFlags::modes())
+        settings.*family->field = modes.value(family->key).toString();
+    const QJsonObject outputs = object.value("outputs").toObject();
+    for (auto it = outputs.constBegin(); it != outputs.constEnd(); ++it)
+        settings.outputs.append(qMakePair(it.key(), it.value().toString()));
+    const QJsonArray colors = object.value("colors").toArray();
+    for (int i = 0; i < 4 && i < colors.size(); ++i) {
+        const QJsonArray rgb = colors[i].toArray();
+        if (rgb.size() == 3)
+            settings.ledColors[i] = {rgb[0].toInt(), rgb[1].toInt(), rgb[2].toInt()};
+    }
+    return settings;
+}
+
+bool ConfigLayers::load()
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QJsonParseError error;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if (error.error != QJsonParseError::NoError || root.value("version").toInt() != layersVersion) {
+        qCWarning(lcExport) << "Ignoring unreadable layer file" << filePath;
+        return false;
+    }
+
+    base = fromJson(root.value("base").toObject());
+    emulators.clear();
+    const QJsonObject emulatorLayers = root.value("emulators").toObject();
+    for (auto it = emulatorLayers.constBegin(); it != emulatorLayers.constEnd(); ++it)
+        emulators.insert(it.key(), fromJson(it.value().toObject()));
+    games.clear();
+    const QJsonObject gameLayers = root.value("games").toObject();
+    for (auto it = gameLayers.constBegin(); it != gameLayers.constEnd(); ++it)
+        games.insert(it.key(), fromJson(it.value().toObject()));
+    return true;
+}
+
+bool ConfigLayers::save() const
+{
+    QJsonObject emulatorLayers;
+    for (auto it = emulators.constBegin(); it != emulators.constEnd(); ++it)
+        emulatorLayers[it.key()] = toJson(it.value());
+    QJsonObject gameLayers;
+    for (auto it = games.constBegin(); it != games.constEnd(); ++it)
+        gameLayers[it.key()] = toJson(it.value());
+
+    QJsonObject root;
+    root["version"] = layersVersion;
+    root["base"] = toJson(base);
+    root["emulators"] = emulatorLayers;
+    root["games"] = gameLayers;
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson());
+    return file.commit();
+}
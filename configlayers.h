@@ -0,0 +1,60 @@
+#ifndef CONFIGLAYERS_H
+#define CONFIGLAYERS_H
+
+#include "bulkedit.h"
+#include "openfireconfig.h"
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Shared OpenFIRE settings kept as layers in layers.json next to
+// settings.ini: a base layer for every game, then optional per-emulator and
+// per-game layers. Each layer only holds what it sets (as in
+// BulkEdit::transform); resolve() stacks base < emulator < game. The
+// game-specific output keys stay in each ini, so regenerating applies the
+// resolved layers to every ini in one parallel pass and only writes files
+// whose content changes.
+class ConfigLayers
+{
+public:
+    enum class Scope { Base, Emulator, Game };
+
+    explicit ConfigLayers(const QString &settingsPath);
+
+    bool load();
+    bool save() const;
+
+    // name is the friendly emulator name or the ROM code; ignored for Base.
+    OpenFireSettings layer(Scope scope, const QString &name = QString()) const;
+    // Stacks settings on top of what the layer already sets.
+    void mergeIntoLayer(Scope scope, const QString &name, const OpenFireSettings &settings);
+    // Removes values from a layer so the layers below apply again; inis
+    // already written keep their current value. Keys are as in layers.json: "start", a mode key
+    // ("device", "rumble", ...), "outputs/<key>" or "colors/<player>".
+    // Returns how many were set; an emulator or game layer left empty is
+    // dropped.
+    int unsetInLayer(Scope scope, const QString &name, const QStringList &keys);
+
+    // What the layers set for one game, by ROM code.
+    OpenFireSettings resolve(const QString &romCode) const;
+
+    // Every ini in iniDir with the resolved layers applied; see BulkEdit::commit().
+    QList<BulkEdit::FileChange> preview(const QString &iniDir) const;
+
+    // Later (set) values in over win; outputs are merged by key.
+    static void overlay(OpenFireSettings &target, const OpenFireSettings &over);
+
+private:
+    static QJsonObject toJson(const OpenFireSettings &settings);
+    static OpenFireSettings fromJson(const QJsonObject &object);
+
+    QString filePath;
+    OpenFireSettings base;
+    QHash<QString, OpenFireSettings> emulators;
+    QHash<QString, OpenFireSettings> games;
+    QHash<QString, QString> emulatorForRom; // from the catalog
+};
+
+#endif // CONFIGLAYERS_H
@@ -0,0 +1,18 @@
+#include "dsqlogging.h"
+#include <QSettings>
+
+Q_LOGGING_CATEGORY(lcCatalog, "dsq.catalog", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcIni, "dsq.ini", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcExport, "dsq.export", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcLaunch, "dsq.launch", QtWarningMsg)
+Q_LOGGING_CATEGORY(lcStartup, "dsq.startup", QtWarningMsg)
+
+void DsqLogging::applySettings(const QString &settingsPath)
+{
+    QSettings settings(settingsPath, QSettings::IniFormat);
+    // QSettings splits unquoted comma lists, so accept both forms.
+    QString rules = settings.value("Logging/Rules").toStringList().join(';');
+    if (rules.trimmed().isEmpty())
+        return;
+    QLoggingCategory::setFilterRules(rules.replace(';', '\n'));
+}
@@ -0,0 +1,26 @@
+#ifndef DSQLOGGING_H
+#define DSQLOGGING_H
+
+#include <QLoggingCategory>
+#include <QString>
+
+// Logging categories. Debug output is off by default and costs one flag
+// check when disabled; building with DSQ_STRIP_DEBUG_LOGGING removes it
+// entirely. Enable at runtime with QT_LOGGING_RULES="dsq.ini.debug=true" or
+// in settings.ini:
+//   [Logging]
+//   Rules=dsq.ini.debug=true;dsq.export.debug=true
+Q_DECLARE_LOGGING_CATEGORY(lcCatalog)   // dsq.catalog: emulator and ROM lookups
+Q_DECLARE_LOGGING_CATEGORY(lcIni)       // dsq.ini: ini load, parse and update
+Q_DECLARE_LOGGING_CATEGORY(lcExport)    // dsq.export: directories and file writes
+Q_DECLARE_LOGGING_CATEGORY(lcLaunch)    // dsq.launch: launching, hooker and daemon
+Q_DECLARE_LOGGING_CATEGORY(lcStartup)   // dsq.startup: main window startup phases
+
+class DsqLogging
+{
+public:
+    // Applies [Logging] Rules from settingsPath. QT_LOGGING_RULES still wins.
+    static void applySettings(const QString &settingsPath);
+};
+
+#endif // DSQLOGGING_H
@@ -0,0 +1,137 @@
+#include "dsqtrace.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    qint64 startNs;
+    qint64 durationNs;
+};
+
+// Spans past this per thread are counted as dropped rather than recorded.
+const int bufferCapacity = 1 << 16;
+
+// Written only by its own thread; count is published with release so a
+// reader on another thread sees complete events up to it.
+struct ThreadBuffer
+{
+    int threadId = 0;
+    std::unique_ptr<Event[]> events{new Event[bufferCapacity]};
+    std::atomic<int> count{0};
+    std::atomic<int> dropped{0};
+};
+
+// Buffers are shared with the registry so they outlive their thread.
+QMutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+int nextThreadId = 1;
+
+const QElapsedTimer &traceClock()
+{
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer started;
+        started.start();
+        return started;
+    }();
+    return timer;
+}
+
+ThreadBuffer &threadBuffer()
+{
+    // Registration takes the lock once per thread; appends never do.
+    thread_local const std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        QMutexLocker locker(&registryMutex);
+        created->threadId = nextThreadId++;
+        registry.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+} // namespace
+
+void DsqTrace::setEnabled(bool on)
+{
+    traceClock();
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+qint64 DsqTrace::nowNs()
+{
+    return traceClock().nsecsElapsed();
+}
+
+void DsqTrace::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    const int index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= bufferCapacity) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[index] = {name, startNs, endNs - startNs};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+QByteArray DsqTrace::toChromeJson()
+{
+    QJsonArray events;
+    QMutexLocker locker(&registryMutex);
+    for (const std::shared_ptr<ThreadBuffer> &buffer : registry) {
+        const int count = buffer->count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            const Event &event = buffer->events[i];
+            QJsonObject entry;
+            entry["name"] = QString::fromLatin1(event.name);
+            entry["ph"] = "X";
+            entry["ts"] = event.startNs / 1000.0;
+            entry["dur"] = event.durationNs / 1000.0;
+            entry["pid"] = 1;
+            entry["tid"] = buffer->threadId;
+            events.append(entry);
+        }
+        if (const int dropped = buffer->dropped.load(std::memory_order_relaxed)) {
+            QJsonObject entry;
+            entry["name"] = QString("dropped %1 spans").arg(dropped);
+            entry["ph"] = "i";
+            entry["s"] = "t";
+            entry["ts"] = nowNs() / 1000.0;
+            entry["pid"] = 1;
+            entry["tid"] = buffer->threadId;
+            events.append(entry);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool DsqTrace::writeChromeTrace(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(toChromeJson()) >= 0;
+}
+
+void DsqTrace::clear()
+{
+    QMutexLocker locker(&registryMutex);
+    for (const std::shared_ptr<ThreadBuffer> &buffer : registry) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef DSQTRACE_H
+#define DSQTRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Scoped timing spans written as Chrome trace JSON (chrome://tracing or
+// ui.perfetto.dev). Off by default; a disabled span is one relaxed atomic
+// load. Each thread appends to its own fixed-size buffer without locking,
+// so spans can be recorded from worker threads as well as the UI thread.
+class DsqTrace
+{
+public:
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on);
+
+    static qint64 nowNs();
+    static void record(const char *name, qint64 startNs, qint64 endNs);
+
+    // Snapshot of every thread's spans so far.
+    static QByteArray toChromeJson();
+    static bool writeChromeTrace(const QString &path);
+    // Only call while no spans are open, e.g. between user actions.
+    static void clear();
+
+private:
+    static inline std::atomic<bool> enabled{false};
+};
+
+// Records name (a string literal) from construction to end of scope.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *spanName)
+        : name(DsqTrace::isEnabled() ? spanName : nullptr),
+          startNs(name ? DsqTrace::nowNs() : 0)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (name)
+            DsqTrace::record(name, startNs, DsqTrace::nowNs());
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *name;
+    qint64 startNs;
+};
+
+#define DSQ_TRACE_CONCAT_(a, b) a##b
+#define DSQ_TRACE_CONCAT(a, b) DSQ_TRACE_CONCAT_(a, b)
+#define DSQ_TRACE_SPAN(name) TraceSpan DSQ_TRACE_CONCAT(dsqTraceSpan, __LINE__)(name)
+
+#endif // DSQTRACE_H
@@ -1,8 +1,13 @@
 #include "emulatorutils.h"
+#include "dsqlogging.h"
+#include "dsqtrace.h"
+#include "exportcache.h"
+#include "textfile.h"
 #include <QDir>
-#include <QDebug>
-#include <QFont>
-#include <QComboBox>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
 #include <QRegularExpression>
 #include <QSet>
 
@@ -14,6 +19,7 @@ EmulatorUtils::EmulatorUtils()
 
 void EmulatorUtils::mapEmulator(QString &friendly, QString &demulShooterExe)
 {
+    DSQ_TRACE_SPAN("EmulatorUtils::mapEmulator");
     static const QHash<QString, QPair<QString, QString>> map = {
         /* ------- 32-bit DemulShooter.exe targets ------- */
         { "Coastal",                          {"coastal",    "DemulShooter.exe"} },
@@ -58,6 +64,7 @@ void EmulatorUtils::mapEmulator(QString &friendly, QString &demulShooterExe)
 
 QString EmulatorUtils::mapRom(const QString &rom)
 {
+    DSQ_TRACE_SPAN("EmulatorUtils::mapRom");
     static const QHash<QString, QString> romMap = {
         /* Coastal */
         { "Wild West Shootout",                          "wws" },
@@ -205,6 +212,7 @@ simplified.remove(QRegularExpression("[^a-z0-9]"));
 
 QString EmulatorUtils::demulRunParameter(const QString &romCode)
 {
+    DSQ_TRACE_SPAN("EmulatorUtils::demulRunParameter");
     static const QSet<QString> awaveRoms = {
         "claychal",
         "rangrmsn",
@@ -216,12 +224,9 @@ QString EmulatorUtils::demulRunParameter(const QString &romCode)
     return awaveRoms.contains(romCode) ? QStringLiteral("awave") : QStringLiteral("naomi");
 }
 
-void EmulatorUtils::updateGamesList(const QString &emuFriendly, QComboBox *romBox)
+QStringList EmulatorUtils::gamesForEmulator(const QString &emuFriendly)
 {
-    if (!romBox) return;
-    romBox->clear();
-    romBox->setEnabled(true);
-
+    DSQ_TRACE_SPAN("EmulatorUtils::gamesForEmulator");
     static const QHash<QString, QStringList> gameList = {
         /* Only show games the wiki lists for that *friendly* emulator name */
         { "Coastal",                     { "Wild West Shootout" } },
@@ -303,14 +308,12 @@ void EmulatorUtils::updateGamesList(const QString &emuFriendly, QComboBox *romBo
               "House of the Dead: Remake (Arcade Plugin)" } }
     };
 
-    if (gameList.contains(emuFriendly))
-        romBox->addItems(gameList.value(emuFriendly));
-    else
-        romBox->setEnabled(false);   // unknown emulator
+    return gameList.value(emuFriendly);
 }
 
 void EmulatorUtils::updateEmulatorPath(const QString &emulator, QString &emulatorPath, QString &romPath)
 {
+    DSQ_TRACE_SPAN("EmulatorUtils::updateEmulatorPath");
     #ifdef Q_OS_WIN
     // Windows-specific paths
     if (emulator == "Coastal") {
@@ -460,9 +463,10 @@ void EmulatorUtils::updateEmulatorPath(const QString &emulator, QString &emulato
     #endif
 }
 
-void EmulatorUtils::setupEmulatorComboBox(QComboBox *box)
+QStringList EmulatorUtils::emulatorList()
 {
-    box->addItems({
+    DSQ_TRACE_SPAN("EmulatorUtils::emulatorList");
+    return {
         "----Demul----",
         "Demul 0.7a",
         "----Sega Model 2----",
@@ -481,16 +485,209 @@ void EmulatorUtils::setupEmulatorComboBox(QComboBox *box)
         "Adrenaline Amusements", "Namco ES3 System", "Raw Thrill Arcade (64-bit)",
         "RPCS3 System 357", "SEGA Amusement Linkage Live System", "Sega Nu",
         "UNIS Technology", "United Distribution Company"
-    });
+    };
+}
+
+bool EmulatorUtils::isDivider(const QString &entry)
+{
+    return entry.startsWith("----");
+}
+
+QString EmulatorUtils::defaultIniHeader()
+{
+    return "[General]\n"
+           "MameStart=\"cmo 1 baud=9600_parity=N_data=8_stop=1\", \"cmo 2 baud=9600_parity=N_data=8_stop=1\", cmw 1 S6, cmw 2 S6\n"
+           "MameStop=cmw 1 E, cmw 2 E, cmc 1, cmc 2\n"
+           "StateChange=\n"
+           "OnRotate=\n"
+           "OnPause=\n\n"
+           "[KeyStates]\n"
+           "RefreshTime=\n\n";
+}
+
+bool EmulatorUtils::demulShooterArgsFromBat(const QString &batContent, QString &args)
+{
+    const QString firstLine = batContent.section('\n', 0, 0);
+    static const QRegularExpression argsRegex(R"(start\s+"Demul"\s+".*"\s+-target=[^\s]+\s+-rom=[^\s]+\s*(.*))",
+                                              QRegularExpression::CaseInsensitiveOption);
+    const auto match = argsRegex.match(firstLine);
+    if (!match.hasMatch())
+        return false;
+    args = match.captured(1).trimmed();
+    return true;
+}
+
+QString EmulatorUtils::loadIniContent(const QString &iniPath)
+{
+    DSQ_TRACE_SPAN("EmulatorUtils::loadIniContent");
+    if (!QFile::exists(iniPath))
+        return defaultIniHeader();
+
+    // Line endings and encoding are put back by TextFile::write() on export
+    QString iniContent;
+    if (TextFile::read(iniPath, iniContent)) {
+        // Check if [General] section exists
+        if (!iniContent.contains("[General]")) {
+            // Add default header at the start
+            iniContent = defaultIniHeader() + iniContent;
+        }
+    }
+    return iniContent;
+}
 
-    box->setMaxVisibleItems(60);
+void EmulatorUtils::exportFilePaths(const QString &qmamehookerPath, const QString &rom,
+                                    QString &iniFilePath, QString &batFilePath)
+{
+    iniFilePath = qmamehookerPath + "/ini/" + mapRom(rom) + ".ini";
+    batFilePath = qmamehookerPath + "/bat/" + rom + ".bat";
+}
 
-    QFont bold; bold.setBold(true);
-    for (int i = 0; i < box->count(); ++i) {
-        const QString txt = box->itemText(i);
-        if (txt.startsWith("----")) {
-            box->setItemData(i, bold, Qt::FontRole);
-            box->setItemData(i, QVariant(0), Qt::UserRole - 1);   // disable selection
+void EmulatorUtils::prepareDirectories(const QString &basePath, QDir &iniDir, QDir &batDir)
+{
+    DSQ_TRACE_SPAN("EmulatorUtils::prepareDirectories");
+    // Create an absolute path using QDir to ensure platform compatibility
+    QDir baseDir(basePath);
+    
+    // Make sure base directory exists
+    if (!baseDir.exists()) {
+        if (!baseDir.mkpath(".")) {
+            qCWarning(lcExport) << "Failed to create base directory:" << basePath;
+            return;
         }
     }
-}
\ No newline at end of file
+    
+    QString iniDirPath = basePath + "/ini";
+    QString batDirPath = basePath + "/bat";
+    
+    iniDir = QDir(iniDirPath);
+    batDir = QDir(batDirPath);
+
+    if (!iniDir.exists()) {
+        if (!iniDir.mkpath(".")) {
+            qCWarning(lcExport) << "Failed to create 'ini' directory:" << iniDirPath;
+        } else {
+            qCDebug(lcExport) << "'ini' directory is ready:" << iniDir.absolutePath();
+        }
+    } else {
+        qCDebug(lcExport) << "'ini' directory is ready:" << iniDir.absolutePath();
+    }
+
+    if (!batDir.exists()) {
+        if (!batDir.mkpath(".")) {
+            qCWarning(lcExport) << "Failed to create 'bat' directory:" << batDirPath;
+        } else {
+            qCDebug(lcExport) << "'bat' directory is ready:" << batDir.absolutePath();
+        }
+    } else {
+        qCDebug(lcExport) << "'bat' directory is ready:" << batDir.absolutePath();
+    }
+}
+
+QString EmulatorUtils::generateBatContent(const QString &rom,
+                                          const QString &emulatorInput,
+                                          const QString &emulatorPath,
+                                          const QString &romPath,
+                                          const QString &qmamehookerPath,
+                                          const QString &demulShooterPath,
+                                          const QString &verbose,
+                                          const QString &demulShooterArgs)
+{
+    DSQ_TRACE_SPAN("EmulatorUtils::generateBatContent");
+    QString emulator = emulatorInput;
+    QString demulShooterExe;
+    mapEmulator(emulator, demulShooterExe);
+    QString rom2 = mapRom(rom);
+
+    QString iniDirPath = QDir(qmamehookerPath + "/ini").absolutePath();
+    QFileInfo emulatorFileInfo(emulatorPath);
+    QString emulatorDirectory = emulatorFileInfo.absolutePath();
+    QString emulatorExecutable = emulatorFileInfo.fileName();
+
+    QString content;
+    QTextStream out(&content);
+    out << "start \"Demul\" \"" << QDir::toNativeSeparators(demulShooterPath + "/" + demulShooterExe)
+        << "\" -target=" << emulator
+        << " -rom=" << rom2;
+    if (!demulShooterArgs.trimmed().isEmpty())
+        out << ' ' << demulShooterArgs.trimmed();
+    out << "\n";
+    out << "start /MIN \"Hooker\" \"" << QDir::toNativeSeparators(qmamehookerPath + "/QMamehook.exe")
+        << "\" -p \"" << QDir::toNativeSeparators(iniDirPath) << "\" " << verbose << " -c \n";
+    out << "cd \"" << QDir::toNativeSeparators(emulatorDirectory) << "\"\n";
+
+    if (emulator == "demul07a") {
+        QString runTarget = demulRunParameter(rom2);
+        out << "start \"demul07a\" \"" << emulatorExecutable << "\" -run=" << runTarget
+            << " -rom=" << rom2;
+    } else if (emulator == "flycast") {
+        out << "start \"" << emulator << "\" " << emulatorExecutable
+            << " -config window:fullscreen=yes \"" << QDir::toNativeSeparators(romPath + "/" + rom2 + ".zip") << "\"";
+    } else if (emulator == "lindbergh" || emulator == "ringwide" || emulator == "rawthrill") {
+        out << "start \"" << emulator << "\" " << emulatorExecutable << " --profile=" << rom2 + ".xml";
+    } else {
+        out << "start \"" << emulator << "\" " << emulatorExecutable << " " << rom2;
+    }
+
+    return content;
+}
+
+bool EmulatorUtils::createFiles(const QString &rom,
+                                const QString &qmamehookerPath,
+                                const QString &iniContent,
+                                const QString &batContent,
+                                const QString &settingsPath)
+{
+    DSQ_TRACE_SPAN("EmulatorUtils::createFiles");
+    QString rom2 = mapRom(rom);
+    // Log the ROM mapping for debugging
+    qCDebug(lcCatalog) << "ROM mapping:" << rom << "->" << rom2;
+
+    QDir iniDir, batDir;
+    prepareDirectories(qmamehookerPath, iniDir, batDir);
+
+    QString iniFilePath, batFilePath;
+    exportFilePaths(qmamehookerPath, rom, iniFilePath, batFilePath);
+    bool ok = true;
+
+    // Create the BAT file with provided content, keeping an existing file's
+    // encoding and line endings
+    if (TextFile::write(batFilePath, batContent)) {
+        qCDebug(lcExport) << "Batch file created at:" << batFilePath;
+    } else {
+        qCWarning(lcExport) << "Failed to create batch file at:" << batFilePath;
+        ok = false;
+    }
+
+    // Create the INI file the same way
+    if (TextFile::write(iniFilePath, iniContent)) {
+        qCDebug(lcExport) << "INI file created at:" << iniFilePath;
+    } else {
+        qCWarning(lcExport) << "Failed to create INI file at:" << iniFilePath;
+        ok = false;
+    }
+
+    // Remember what is now on disk so the next launch can skip an identical export
+    if (ok) {
+        ExportCache exportCache(settingsPath);
+        exportCache.record(rom2,
+                           ExportCache::fingerprint(iniFilePath, batFilePath, iniContent, batContent),
+                           iniFilePath, batFilePath);
+    }
+
+    return ok;
+}
+
+bool EmulatorUtils::launchBatch(const QString &batFilePath)
+{
+    DSQ_TRACE_SPAN("EmulatorUtils::launchBatch");
+    const QString workingDir = QFileInfo(batFilePath).absolutePath();
+
+    #ifdef Q_OS_WIN
+    // On Windows, use cmd.exe to run the batch file
+    return QProcess::startDetached("cmd.exe", {"/c", QDir::toNativeSeparators(batFilePath)}, workingDir);
+    #else
+    // On other platforms, make the file executable and run it directly
+    QFile::setPermissions(batFilePath, QFile::permissions(batFilePath) | QFile::ExeUser);
+    return QProcess::startDetached("/bin/sh", {batFilePath}, workingDir);
+    #endif
+}
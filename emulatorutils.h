@@ -3,7 +3,7 @@
 
 #include <QString>
 #include <QStringList>
-#include <QComboBox>
+#include <QDir>
 
 class EmulatorUtils
 {
@@ -12,12 +12,38 @@ public:
     
     // Utility functions moved from MainWindow
     static void updateEmulatorPath(const QString &emulator, QString &emulatorPath, QString &romPath);
-    static void updateGamesList(const QString &emulator, QComboBox *romComboBox);
     static QString mapRom(const QString &rom);
     static void mapEmulator(QString &emulator, QString &demulShooterExe);
-    static void setupEmulatorComboBox(QComboBox *emulatorComboBox);
     static QString demulRunParameter(const QString &romCode);
 
+    // Catalog access without any widgets involved
+    static QStringList emulatorList();
+    static bool isDivider(const QString &entry);
+    static QStringList gamesForEmulator(const QString &emulator);
+
+    // Generation and export shared by the GUI and the headless CLI
+    static QString defaultIniHeader();
+    static QString loadIniContent(const QString &iniPath);
+    // DemulShooter extra arguments from the first line of an exported bat.
+    static bool demulShooterArgsFromBat(const QString &batContent, QString &args);
+    static void exportFilePaths(const QString &qmamehookerPath, const QString &rom,
+                                QString &iniFilePath, QString &batFilePath);
+    static void prepareDirectories(const QString &basePath, QDir &iniDir, QDir &batDir);
+    static QString generateBatContent(const QString &rom,
+                                      const QString &emulatorInput,
+                                      const QString &emulatorPath,
+                                      const QString &romPath,
+                                      const QString &qmamehookerPath,
+                                      const QString &demulShooterPath,
+                                      const QString &verbose,
+                                      const QString &demulShooterArgs);
+    static bool createFiles(const QString &rom,
+                            const QString &qmamehookerPath,
+                            const QString &iniContent,
+                            const QString &batContent,
+                            const QString &settingsPath);
+    static bool launchBatch(const QString &batFilePath);
+
 private:
     // Any private constants/methods if needed
 };
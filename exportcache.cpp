@@ -0,0 +1,74 @@
+#include "exportcache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSettings>
+
+ExportCache::ExportCache(const QString &settingsPath)
+    : settingsPath(settingsPath)
+{
+}
+
+QByteArray ExportCache::fingerprint(const QString &iniPath,
+                                    const QString &batPath,
+                                    const QString &iniContent,
+                                    const QString &batContent)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(iniPath.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(batPath.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(iniContent.toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(batContent.toUtf8());
+    return hash.result().toHex();
+}
+
+QString ExportCache::fileStamp(const QString &path)
+{
+    // Size + mtime is enough to notice an external edit without reading the file.
+    QFileInfo info(path);
+    if (!info.exists())
+        return QString();
+    return QString("%1:%2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+bool ExportCache::isCurrent(const QString &romCode,
+                            const QByteArray &fingerprint,
+                            const QString &iniPath,
+                            const QString &batPath) const
+{
+    QSettings settings(settingsPath, QSettings::IniFormat);
+    settings.beginGroup("Export");
+    settings.beginGroup(romCode);
+    const QByteArray stored = settings.value("Fingerprint").toByteArray();
+    const QString iniStamp = settings.value("IniStamp").toString();
+    const QString batStamp = settings.value("BatStamp").toString();
+    settings.endGroup();
+    settings.endGroup();
+
+    if (stored.isEmpty() || stored != fingerprint)
+        return false;
+
+    const QString currentIni = fileStamp(iniPath);
+    const QString currentBat = fileStamp(batPath);
+    return !currentIni.isEmpty() && !currentBat.isEmpty()
+           && currentIni == iniStamp && currentBat == batStamp;
+}
+
+void ExportCache::record(const QString &romCode,
+                         const QByteArray &fingerprint,
+                         const QString &iniPath,
+                         const QString &batPath)
+{
+    QSettings settings(settingsPath, QSettings::IniFormat);
+    settings.beginGroup("Export");
+    settings.beginGroup(romCode);
+    settings.setValue("Fingerprint", fingerprint);
+    settings.setValue("IniStamp", fileStamp(iniPath));
+    settings.setValue("BatStamp", fileStamp(batPath));
+    settings.endGroup();
+    settings.endGroup();
+    settings.sync();
+}
@@ -0,0 +1,37 @@
+#ifndef EXPORTCACHE_H
+#define EXPORTCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+// Remembers what was last written for each game so a launch can skip
+// re-exporting when the ini and bat on disk already match.
+class ExportCache
+{
+public:
+    explicit ExportCache(const QString &settingsPath);
+
+    static QByteArray fingerprint(const QString &iniPath,
+                                  const QString &batPath,
+                                  const QString &iniContent,
+                                  const QString &batContent);
+
+    // True when the last recorded export for this game produced the same
+    // fingerprint and neither file has been touched since.
+    bool isCurrent(const QString &romCode,
+                   const QByteArray &fingerprint,
+                   const QString &iniPath,
+                   const QString &batPath) const;
+
+    void record(const QString &romCode,
+                const QByteArray &fingerprint,
+                const QString &iniPath,
+                const QString &batPath);
+
+private:
+    static QString fileStamp(const QString &path);
+
+    QString settingsPath;
+};
+
+#endif // EXPORTCACHE_H
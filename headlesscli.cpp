@@ -0,0 +1,579 @@
+#include "headlesscli.h"
+#include "configlayers.h"
+#include "dsqlogging.h"
+#include "emulatorutils.h"
+#include "exportcache.h"
+#include "roundtripcheck.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QSettings>
+#include <cstdio>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+// Commands that switch the executable into headless mode.
+static const char *const headlessCommands[] = {
+    "--help", "-h", "--list-emulators", "--list-games", "--export", "--check", "--launch",
+    "--daemon", "--request", "--stress",
+    "--roundtrip", "--apply-layers", "--unset-layer"
+};
+
+HeadlessCli::HeadlessCli()
+    : out(stdout), err(stderr)
+{
+}
+
+bool HeadlessCli::isHeadlessInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        for (const char *command : headlessCommands) {
+            if (std::strcmp(argv[i], command) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+int HeadlessCli::run(const QStringList &arguments)
+{
+#ifdef Q_OS_WIN
+    // The executable is built as a GUI app; borrow the calling console for output.
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("DemulEASY headless mode: generate and launch QMamehook/DemulShooter configs.");
+    parser.addHelpOption();
+
+    QCommandLineOption listEmulatorsOption("list-emulators", "List the supported emulators.");
+    QCommandLineOption listGamesOption("list-games", "List games (and ROM codes) for [emulator], or for every emulator.");
+    QCommandLineOption exportOption("export", "Export bat/ini for <emulator|all> <game|all>.");
+    QCommandLineOption checkOption("check", "Report missing or stale exports for <emulator|all> <game|all>.");
+    QCommandLineOption launchOption("launch", "Export if needed, then launch <emulator> <game>.");
+    QCommandLineOption settingsOption("settings", "Settings file to read paths from.", "file");
+    QCommandLineOption qmamehookOption("qmamehook", "QMamehook directory.", "dir");
+    QCommandLineOption demulShooterOption("demulshooter", "DemulShooter directory.", "dir");
+    QCommandLineOption emulatorPathOption("emulator-path", "Emulator executable (default: per-emulator default).", "file");
+    QCommandLineOption romPathOption("rom-path", "ROM directory (default: per-emulator default).", "dir");
+    QCommandLineOption argsOption("args", "Extra DemulShooter arguments.", "args");
+    QCommandLineOption verboseOption("verbose", "Pass -v to QMamehook in generated bats.");
+    QCommandLineOption forceOption("force", "Rewrite files even when they are already current.");
+    QCommandLineOption daemonOption("daemon", "Run the resident launcher on a local socket.");
+    QCommandLineOption socketOption("socket", "Local socket name for --daemon/--request/--stress.", "name",
+                                    LaunchDaemon::defaultServerName());
+    QCommandLineOption requestOption("request", "Send one JSON request to a running daemon and print the reply.", "json");
+    QCommandLineOption stressOption("stress", "Send <count> plan/status/launch/stop requests (launch and stop as dry runs) to a running daemon and verify the replies.", "count");
+    QCommandLineOption roundTripOption("roundtrip", "Round-trip every ini in [dir] (default: <qmamehook>/ini) and report changes.");
+    QCommandLineOption goldenOption("golden", "Compare --roundtrip output with the files in <dir>.", "dir");
+    QCommandLineOption updateGoldenOption("update-golden", "Write the --roundtrip output to the --golden folder.");
+    QCommandLineOption timeLimitOption("time-limit", "Per-file --roundtrip time limit in milliseconds.", "ms", "50");
+    QCommandLineOption applyLayersOption("apply-layers", "Rewrite every ini in [dir] (default: <qmamehook>/ini) from the settings layers in layers.json; with --check only report.");
+    QCommandLineOption unsetLayerOption("unset-layer", "Remove <keys> (comma-separated: start, a mode such as device, outputs/<key>, colors/<player>) from the layer for [emulator] [game], or from the every-game layer when neither is given.", "keys");
+
+    parser.addOptions({listEmulatorsOption, listGamesOption, exportOption, checkOption, launchOption,
+                       settingsOption, qmamehookOption, demulShooterOption, emulatorPathOption,
+                       romPathOption, argsOption, verboseOption, forceOption, daemonOption,
+                       socketOption, requestOption, stressOption, roundTripOption,
+                       goldenOption, updateGoldenOption, timeLimitOption, applyLayersOption, unsetLayerOption});
+    parser.addPositionalArgument("emulator", "Friendly emulator name, e.g. \"Demul 0.7a\", or all.");
+    parser.addPositionalArgument("game", "Friendly game name, e.g. \"Confidential Mission\", or all.");
+    parser.process(arguments);
+
+    // Paths come from the GUI's settings.ini unless overridden on the command line.
+    settingsPath = parser.isSet(settingsOption)
+                       ? parser.value(settingsOption)
+                       : QDir(QCoreApplication::applicationDirPath()).filePath("settings.ini");
+    DsqLogging::applySettings(settingsPath);
+    QSettings settings(settingsPath, QSettings::IniFormat);
+#ifdef Q_OS_WIN
+    const QString defaultQmamehook = "C:/QMamehook";
+    const QString defaultDemulShooter = "C:/DemulShooter";
+#else
+    const QString defaultQmamehook = QDir::homePath() + "/QMamehook";
+    const QString defaultDemulShooter = QDir::homePath() + "/DemulShooter";
+#endif
+    qmamehookerPath = settings.value("Paths/QMamehook").toString();
+    if (qmamehookerPath.isEmpty()) qmamehookerPath = defaultQmamehook;
+    demulShooterPath = settings.value("Paths/DemulShooter").toString();
+    if (demulShooterPath.isEmpty()) demulShooterPath = defaultDemulShooter;
+    demulShooterArgs = settings.value("General/DemulShooterArgs").toString();
+
+    if (parser.isSet(qmamehookOption)) qmamehookerPath = parser.value(qmamehookOption);
+    if (parser.isSet(demulShooterOption)) demulShooterPath = parser.value(demulShooterOption);
+    if (parser.isSet(argsOption)) demulShooterArgs = parser.value(argsOption);
+    emulatorPathOverride = parser.value(emulatorPathOption);
+    romPathOverride = parser.value(romPathOption);
+    verbose = parser.isSet(verboseOption) ? "-v" : "";
+    force = parser.isSet(forceOption);
+    layers = std::make_unique<ConfigLayers>(settingsPath);
+    layers->load();
+
+    const QStringList positional = parser.positionalArguments();
+    const QString emulator = positional.value(0);
+    const QString game = positional.value(1);
+
+    if (parser.isSet(daemonOption))
+        return runDaemon(parser.value(socketOption));
+    if (parser.isSet(requestOption))
+        return sendRequest(parser.value(socketOption), parser.value(requestOption));
+    if (parser.isSet(stressOption))
+        return stressDaemon(parser.value(socketOption), parser.value(stressOption).toInt());
+    if (parser.isSet(roundTripOption))
+        return roundTrip(emulator.isEmpty() ? QDir(qmamehookerPath).filePath("ini") : emulator,
+                         parser.value(goldenOption), parser.value(timeLimitOption).toInt(),
+                         parser.isSet(updateGoldenOption));
+    if (parser.isSet(applyLayersOption))
+        return applyLayers(emulator.isEmpty() ? QDir(qmamehookerPath).filePath("ini") : emulator,
+                           parser.isSet(checkOption));
+    if (parser.isSet(unsetLayerOption))
+        return unsetLayer(emulator, game, parser.value(unsetLayerOption).split(','));
+    if (parser.isSet(listEmulatorsOption))
+        return listEmulators();
+    if (parser.isSet(listGamesOption))
+        return listGames(emulator);
+
+    if (parser.isSet(exportOption) || parser.isSet(checkOption) || parser.isSet(launchOption)) {
+        if (positional.size() != 2) {
+            err << "Expected <emulator> <game> arguments.\n";
+            return 2;
+        }
+        if (parser.isSet(launchOption))
+            return launch(emulator, game);
+        return exportGames(emulator, game, parser.isSet(checkOption));
+    }
+
+    parser.showHelp(2);
+    return 2;
+}
+
+int HeadlessCli::roundTrip(const QString &iniDir, const QString &goldenDir, int timeLimitMs, bool updateGolden)
+{
+    if (updateGolden && goldenDir.isEmpty()) {
+        err << "--update-golden needs --golden <dir>\n";
+        return 2;
+    }
+
+    RoundTripCheck check(goldenDir, timeLimitMs, updateGolden);
+    const QList<RoundTripCheck::FileResult> results = check.checkDirectory(iniDir);
+    if (results.isEmpty()) {
+        err << "No ini files in " << iniDir << '\n';
+        return 2;
+    }
+
+    int failed = 0;
+    qint64 slowestUs = 0;
+    for (const RoundTripCheck::FileResult &result : results) {
+        slowestUs = qMax(slowestUs, result.elapsedUs);
+        if (result.passed())
+            continue;
+        ++failed;
+        for (const QString &problem : result.problems)
+            out << result.fileName << '\t' << problem << '\n';
+    }
+
+    out << results.size() - failed << " of " << results.size() << " inis round-trip cleanly (slowest "
+        << QString::number(slowestUs / 1000.0, 'f', 2) << " ms)\n";
+    return failed == 0 ? 0 : 1;
+}
+
+int HeadlessCli::applyLayers(const QString &iniDir, bool checkOnly)
+{
+    if (!layers->load()) {
+        err << "No settings layers in " << QFileInfo(settingsPath).absoluteDir().filePath("layers.json") << '\n';
+        return 2;
+    }
+
+    const QList<BulkEdit::FileChange> files = layers->preview(iniDir);
+    const QString summary = BulkEdit::summary(files);
+    if (!summary.isEmpty())
+        out << summary << '\n';
+    const int changed = summary.isEmpty() ? 0 : summary.count('\n') + 1;
+    out << changed << " of " << files.size() << " inis " << (checkOnly ? "differ from" : "updated from")
+        << " the layers\n";
+    if (checkOnly)
+        return changed == 0 ? 0 : 1;
+
+    const QStringList failures = BulkEdit::commit(files);
+    for (const QString &path : failures)
+        err << "Not written (changed meanwhile or unwritable): " << path << '\n';
+    return failures.isEmpty() ? 0 : 1;
+}
+
+int HeadlessCli::unsetLayer(const QString &emulator, const QString &game, const QStringList &keys)
+{
+    ConfigLayers::Scope scope = ConfigLayers::Scope::Base;
+    QString name;
+    if (!game.isEmpty()) {
+        scope = ConfigLayers::Scope::Game;
+        name = EmulatorUtils::mapRom(game);
+        if (name.isEmpty()) {
+            err << "Unknown game: " << game << '\n';
+            return 2;
+        }
+    } else if (!emulator.isEmpty()) {
+        scope = ConfigLayers::Scope::Emulator;
+        name = emulator;
+        if (!EmulatorUtils::emulatorList().contains(emulator) || EmulatorUtils::isDivider(emulator)) {
+            err << "Unknown emulator: " << emulator << '\n';
+            return 2;
+        }
+    }
+
+    QStringList trimmedKeys;
+    for (const QString &key : keys) {
+        if (!key.trimmed().isEmpty())
+            trimmedKeys << key.trimmed();
+    }
+    const int removed = layers->unsetInLayer(scope, name, trimmedKeys);
+    if (removed == 0) {
+        out << "Nothing to remove\n";
+        return 0;
+    }
+    if (!layers->save()) {
+        err << "Failed to write " << QFileInfo(settingsPath).absoluteDir().filePath("layers.json") << '\n';
+        return 1;
+    }
+    out << "Removed " << removed << " values; run --apply-layers to rewrite the inis\n";
+    return 0;
+}
+
+int HeadlessCli::listEmulators()
+{
+    for (const QString &emulator : EmulatorUtils::emulatorList()) {
+        if (!EmulatorUtils::isDivider(emulator))
+            out << emulator << '\n';
+    }
+    return 0;
+}
+
+int HeadlessCli::listGames(const QString &emulator)
+{
+    bool ok = true;
+    const QList<Target> targets = resolveTargets(emulator.isEmpty() ? "all" : emulator, "all", ok);
+    if (!ok)
+        return 1;
+
+    for (const Target &target : targets)
+        out << target.emulator << '\t' << target.game << '\t' << EmulatorUtils::mapRom(target.game) << '\n';
+    return 0;
+}
+
+QList<HeadlessCli::Target> HeadlessCli::resolveTargets(const QString &emulator, const QString &game, bool &ok)
+{
+    ok = true;
+    QStringList emulators;
+    if (emulator.compare("all", Qt::CaseInsensitive) == 0) {
+        for (const QString &entry : EmulatorUtils::emulatorList()) {
+            if (!EmulatorUtils::isDivider(entry))
+                emulators << entry;
+        }
+    } else if (!EmulatorUtils::gamesForEmulator(emulator).isEmpty()) {
+        emulators << emulator;
+    } else {
+        err << "Unknown emulator: " << emulator << '\n';
+        ok = false;
+        return {};
+    }
+
+    QList<Target> targets;
+    for (const QString &emu : emulators) {
+        const QStringList games = EmulatorUtils::gamesForEmulator(emu);
+        if (game.compare("all", Qt::CaseInsensitive) == 0) {
+            for (const QString &g : games)
+                targets.append({emu, g});
+        } else if (games.contains(game)) {
+            targets.append({emu, game});
+        }
+    }
+
+    if (targets.isEmpty()) {
+        err << "No game named \"" << game << "\" for " << emulator << '\n';
+        ok = false;
+    }
+    return targets;
+}
+
+LaunchPaths HeadlessCli::launchPaths() const
+{
+    LaunchPaths paths;
+    paths.qmamehookerPath = qmamehookerPath;
+    paths.demulShooterPath = demulShooterPath;
+    paths.demulShooterArgs = demulShooterArgs;
+    paths.emulatorPath = emulatorPathOverride;
+    paths.romPath = romPathOverride;
+    paths.verbose = verbose;
+    return paths;
+}
+
+QString HeadlessCli::batContentFor(const Target &target) const
+{
+    return LaunchPlan::generateBat(target.emulator, target.game, launchPaths());
+}
+
+bool HeadlessCli::exportTarget(const Target &target, bool checkOnly, bool &written)
+{
+    written = false;
+
+    const LaunchPlan plan = buildPlan(target);
+    const QString &iniFilePath = plan.iniFilePath;
+    const QString &batFilePath = plan.batFilePath;
+
+    ExportCache exportCache(settingsPath);
+    const bool current = exportCache.isCurrent(plan.romCode, plan.fingerprint, iniFilePath, batFilePath);
+
+    if (checkOnly) {
+        if (!current) {
+            const bool missing = !QFileInfo::exists(iniFilePath) || !QFileInfo::exists(batFilePath);
+            out << (missing ? "missing\t" : "stale\t") << target.emulator << '\t' << target.game << '\n';
+        }
+        return current;
+    }
+
+    if (current && !force)
+        return true;
+
+    if (!EmulatorUtils::createFiles(target.game, qmamehookerPath, plan.iniContent, plan.batContent, settingsPath)) {
+        err << "Failed to export " << target.emulator << " / " << target.game << '\n';
+        return false;
+    }
+    written = true;
+    return true;
+}
+
+int HeadlessCli::exportGames(const QString &emulator, const QString &game, bool checkOnly)
+{
+    bool ok = true;
+    const QList<Target> targets = resolveTargets(emulator, game, ok);
+    if (!ok)
+        return 2;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int written = 0;
+    int failed = 0;
+    for (const Target &target : targets) {
+        bool wrote = false;
+        if (!exportTarget(target, checkOnly, wrote))
+            ++failed;
+        if (wrote)
+            ++written;
+    }
+
+    if (checkOnly) {
+        out << targets.size() - failed << " of " << targets.size() << " exports current\n";
+    } else {
+        out << "Exported " << written << " of " << targets.size() << " games ("
+            << targets.size() - written - failed << " already current) in "
+            << timer.elapsed() << " ms\n";
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+int HeadlessCli::launch(const QString &emulator, const QString &game)
+{
+    bool ok = true;
+    const QList<Target> targets = resolveTargets(emulator, game, ok);
+    if (!ok || targets.size() != 1) {
+        if (ok)
+            err << "--launch needs a single emulator and game\n";
+        return 2;
+    }
+
+    bool written = false;
+    if (!exportTarget(targets.first(), false, written))
+        return 1;
+
+    QString iniFilePath, batFilePath;
+    EmulatorUtils::exportFilePaths(qmamehookerPath, game, iniFilePath, batFilePath);
+    const bool started = EmulatorUtils::launchBatch(batFilePath);
+
+    if (!started) {
+        err << "Failed to launch " << batFilePath << '\n';
+        return 1;
+    }
+    out << "Launched " << game << '\n';
+    return 0;
+}
+
+LaunchPlan HeadlessCli::buildPlan(const Target &target) const
+{
+    return LaunchPlan::resolve(target.emulator, target.game, launchPaths(), layers.get());
+}
+
+int HeadlessCli::runDaemon(const QString &serverName)
+{
+    LaunchDaemon daemon(
+        [this]() {
+            bool ok = true;
+            QList<LaunchPlan> plans;
+            for (const Target &target : resolveTargets("all", "all", ok))
+                plans.append(buildPlan(target));
+            return plans;
+        },
+        [this](const QString &emulator, const QString &game) {
+            return buildPlan({emulator, game});
+        },
+        settingsPath);
+
+    if (!daemon.listen(serverName)) {
+        err << "Cannot listen on " << serverName << ": " << daemon.errorString() << '\n';
+        return 1;
+    }
+
+    out << "Listening on " << serverName << " with " << daemon.planCount() << " launch plans\n";
+    out.flush();
+    return QCoreApplication::exec();
+}
+
+int HeadlessCli::sendRequest(const QString &serverName, const QString &request)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(2000)) {
+        err << "Cannot connect to " << serverName << ": " << socket.errorString() << '\n';
+        return 1;
+    }
+
+    socket.write(request.toUtf8().trimmed() + '\n');
+    while (!socket.canReadLine()) {
+        if (!socket.waitForReadyRead(5000)) {
+            err << "No reply from " << serverName << '\n';
+            return 1;
+        }
+    }
+    const QByteArray reply = socket.readLine().trimmed();
+    out << reply << '\n';
+    return QJsonDocument::fromJson(reply).object().value("ok").toBool() ? 0 : 1;
+}
+
+int HeadlessCli::stressDaemon(const QString &serverName, int count)
+{
+    if (count <= 0) {
+        err << "--stress needs a positive request count\n";
+        return 2;
+    }
+
+    // Expected replies come from the same generation code the daemon uses.
+    bool ok = true;
+    const QList<Target> targets = resolveTargets("all", "all", ok);
+    QList<QString> expectedBats;
+    QList<QString> expectedRoms;
+    for (const Target &target : targets) {
+        expectedBats.append(batContentFor(target));
+        expectedRoms.append(EmulatorUtils::mapRom(target.game));
+    }
+
+    // Mostly plans, with status, launch and stop mixed in. Launch and stop
+    // are dry runs so the test never writes, starts or kills anything; a dry
+    // launch still reads the process list, so its replies arrive late.
+    enum class Kind { Plan, Status, Launch, Stop };
+    auto kindOf = [](int id) {
+        if (id % 100 == 49)
+            return Kind::Stop;
+        if (id % 10 == 9)
+            return Kind::Status;
+        if (id % 10 == 4)
+            return Kind::Launch;
+        return Kind::Plan;
+    };
+
+    // A second client pings while the first one's launches wait for the
+    // process list, to show the daemon keeps answering meanwhile.
+    QLocalSocket socket;
+    QLocalSocket pinger;
+    for (QLocalSocket *client : {&socket, &pinger}) {
+        client->connectToServer(serverName);
+        if (!client->waitForConnected(2000)) {
+            err << "Cannot connect to " << serverName << ": " << client->errorString() << '\n';
+            return 1;
+        }
+    }
+
+    // Pipeline requests in windows so neither side's buffers grow unbounded.
+    const int window = 64;
+    int sent = 0;
+    int received = 0;
+    int mismatches = 0;
+    qint64 slowestPingNs = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    while (received < count) {
+        QByteArray batch;
+        const int batchEnd = qMin(count, sent + window);
+        for (; sent < batchEnd; ++sent) {
+            QJsonObject request{{"id", sent}};
+            const Kind kind = kindOf(sent);
+            if (kind == Kind::Status) {
+                request.insert("cmd", "status");
+            } else if (kind == Kind::Stop) {
+                request.insert("cmd", "stop");
+                request.insert("dryRun", true);
+            } else {
+                const Target &target = targets.at(sent % targets.size());
+                request.insert("cmd", kind == Kind::Launch ? "launch" : "plan");
+                request.insert("emulator", target.emulator);
+                request.insert("game", target.game);
+                if (kind == Kind::Launch)
+                    request.insert("dryRun", true);
+            }
+            batch += QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n';
+        }
+        socket.write(batch);
+        socket.flush();
+
+        QElapsedTimer ping;
+        ping.start();
+        pinger.write("{\"cmd\":\"ping\"}\n");
+        while (!pinger.canReadLine()) {
+            if (!pinger.waitForReadyRead(5000)) {
+                err << "Daemon stopped answering pings after " << received << " replies\n";
+                return 1;
+            }
+        }
+        pinger.readLine();
+        slowestPingNs = qMax(slowestPingNs, ping.nsecsElapsed());
+
+        while (received < sent) {
+            if (!socket.canReadLine() && !socket.waitForReadyRead(5000)) {
+                err << "Daemon stopped answering after " << received << " replies\n";
+                return 1;
+            }
+            while (socket.canReadLine()) {
+                const QJsonObject reply = QJsonDocument::fromJson(socket.readLine()).object();
+                const int id = reply.value("id").toInt(-1);
+                bool good = reply.value("ok").toBool() && id == received;
+                if (good && kindOf(id) == Kind::Plan)
+                    good = reply.value("bat").toString() == expectedBats.at(id % targets.size());
+                if (good && kindOf(id) == Kind::Launch)
+                    good = reply.value("state").toString() == "dry-run"
+                           && reply.value("rom").toString() == expectedRoms.at(id % targets.size())
+                           && reply.value("running").isArray();
+                if (!good)
+                    ++mismatches;
+                ++received;
+            }
+        }
+    }
+
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    out << "Sent " << count << " requests in " << elapsedNs / 1000000.0 << " ms ("
+        << (count * 1e9) / qMax<qint64>(1, elapsedNs) << " req/s, "
+        << elapsedNs / 1000.0 / count << " us/request), slowest ping " << slowestPingNs / 1000000.0
+        << " ms, " << mismatches << " mismatched replies\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#ifndef HEADLESSCLI_H
+#define HEADLESSCLI_H
+
+#include "configlayers.h"
+#include "launchdaemon.h"
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <memory>
+
+// Command-line front end for scripted provisioning. Runs on a bare
+// QCoreApplication and drives the same EmulatorUtils generation code the
+// GUI uses, so exported files are identical either way.
+class HeadlessCli
+{
+public:
+    HeadlessCli();
+
+    // True when argv asks for a headless command rather than the GUI.
+    static bool isHeadlessInvocation(int argc, char *argv[]);
+
+    int run(const QStringList &arguments);
+
+private:
+    struct Target
+    {
+        QString emulator;
+        QString game;
+    };
+
+    int listEmulators();
+    int listGames(const QString &emulator);
+    int exportGames(const QString &emulator, const QString &game, bool checkOnly);
+    int launch(const QString &emulator, const QString &game);
+    int runDaemon(const QString &serverName);
+    int sendRequest(const QString &serverName, const QString &request);
+    int stressDaemon(const QString &serverName, int count);
+    int roundTrip(const QString &iniDir, const QString &goldenDir, int timeLimitMs, bool updateGolden);
+    int applyLayers(const QString &iniDir, bool checkOnly);
+    int unsetLayer(const QString &emulator, const QString &game, const QStringList &keys);
+
+    QList<Target> resolveTargets(const QString &emulator, const QString &game, bool &ok);
+    LaunchPaths launchPaths() const;
+    QString batContentFor(const Target &target) const;
+    bool exportTarget(const Target &target, bool checkOnly, bool &written);
+    LaunchPlan buildPlan(const Target &target) const;
+
+    QString settingsPath;
+    QString qmamehookerPath;
+    QString demulShooterPath;
+    QString demulShooterArgs;
+    QString emulatorPathOverride;
+    QString romPathOverride;
+    QString verbose;
+    bool force = false;
+    // layers.json, applied to every exported and launched ini
+    std::unique_ptr<ConfigLayers> layers;
+
+    QTextStream out;
+    QTextStream err;
+};
+
+#endif // HEADLESSCLI_H
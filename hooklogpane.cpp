@@ -0,0 +1,210 @@
+#include "hooklogpane.h"
+#include <QComboBox>
+#include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTextStream>
+#include <QTimer>
+#include <QVBoxLayout>
+
+// How long incoming lines are collected before the view is updated.
+static const int flushIntervalMs = 100;
+// How often a followed log file is checked for new output, and how much of
+// it is read at once.
+static const int followIntervalMs = 250;
+static const qint64 followChunkBytes = 1024 * 1024;
+
+HookLogPane::HookLogPane(int capacity, QWidget *parent)
+    : QWidget(parent),
+      ring(qMax(1, capacity)),
+      view(new QPlainTextEdit(this)),
+      playerFilter(new QComboBox(this)),
+      keyFilter(new QLineEdit(this)),
+      flushTimer(new QTimer(this)),
+      followTimer(new QTimer(this))
+{
+    view->setReadOnly(true);
+    view->setMaximumBlockCount(ring.size());
+    view->setLineWrapMode(QPlainTextEdit::NoWrap);
+    view->setUndoRedoEnabled(false);
+
+    playerFilter->addItems({"All players", "P1", "P2", "P3", "P4"});
+    keyFilter->setPlaceholderText("Filter by key, e.g. CtmRecoil");
+    keyFilter->setClearButtonEnabled(true);
+
+    QPushButton *saveButton = new QPushButton("Save Trace...", this);
+    QPushButton *clearButton = new QPushButton("Clear", this);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout;
+    filterLayout->addWidget(playerFilter);
+    filterLayout->addWidget(keyFilter, 1);
+    filterLayout->addWidget(saveButton);
+    filterLayout->addWidget(clearButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(filterLayout);
+    layout->addWidget(view);
+
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(flushIntervalMs);
+    followTimer->setInterval(followIntervalMs);
+
+    connect(flushTimer, &QTimer::timeout, this, &HookLogPane::flushPending);
+    connect(followTimer, &QTimer::timeout, this, &HookLogPane::readFollowed);
+    connect(playerFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &HookLogPane::rebuildView);
+    connect(keyFilter, &QLineEdit::textChanged, this, &HookLogPane::rebuildView);
+    connect(saveButton, &QPushButton::clicked, this, &HookLogPane::saveTrace);
+    connect(clearButton, &QPushButton::clicked, this, &HookLogPane::clear);
+}
+
+void HookLogPane::appendOutput(const QByteArray &data)
+{
+    partialLine += QString::fromLocal8Bit(data);
+
+    int start = 0;
+    int newline;
+    while ((newline = partialLine.indexOf('\n', start)) >= 0) {
+        int end = newline;
+        if (end > start && partialLine.at(end - 1) == '\r')
+            --end;
+        appendLine(partialLine.mid(start, end - start));
+        start = newline + 1;
+    }
+    partialLine.remove(0, start);
+}
+
+void HookLogPane::appendLine(const QString &line)
+{
+    const int capacity = ring.size();
+    if (ringCount < capacity) {
+        ring[(ringHead + ringCount) % capacity] = line;
+        ++ringCount;
+    } else {
+        // Full: overwrite the oldest line.
+        ring[ringHead] = line;
+        ringHead = (ringHead + 1) % capacity;
+    }
+
+    pending.append(line);
+    if (pending.size() > capacity)
+        pending.removeFirst();
+    if (!flushTimer->isActive())
+        flushTimer->start();
+}
+
+void HookLogPane::clear()
+{
+    ringHead = 0;
+    ringCount = 0;
+    pending.clear();
+    partialLine.clear();
+    view->clear();
+}
+
+void HookLogPane::follow(const QString &path)
+{
+    // Pick up the last lines of the previous run first
+    readFollowed();
+    if (!partialLine.isEmpty()) {
+        appendLine(partialLine);
+        partialLine.clear();
+    }
+    followedPath = path;
+    followOffset = 0;
+    followTimer->start();
+}
+
+void HookLogPane::readFollowed()
+{
+    if (followedPath.isEmpty())
+        return;
+    QFile file(followedPath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    // A shorter file has been truncated for a new run
+    const qint64 size = file.size();
+    if (size < followOffset)
+        followOffset = 0;
+    if (size == followOffset || !file.seek(followOffset))
+        return;
+    const QByteArray data = file.read(qMin(size - followOffset, followChunkBytes));
+    followOffset += data.size();
+    appendOutput(data);
+}
+
+void HookLogPane::flushPending()
+{
+    if (pending.isEmpty())
+        return;
+
+    QStringList visible;
+    for (const QString &line : pending) {
+        if (matchesFilter(line))
+            visible.append(line);
+    }
+    pending.clear();
+
+    // One document update per batch instead of one per line.
+    if (!visible.isEmpty())
+        view->appendPlainText(visible.join('\n'));
+}
+
+void HookLogPane::rebuildView()
+{
+    pending.clear();
+    QStringList visible;
+    for (const QString &line : bufferedLines()) {
+        if (matchesFilter(line))
+            visible.append(line);
+    }
+    view->setPlainText(visible.join('\n'));
+    view->moveCursor(QTextCursor::End);
+}
+
+bool HookLogPane::matchesFilter(const QString &line) const
+{
+    const int player = playerFilter->currentIndex();
+    if (player > 0
+        && !line.contains(QString("P%1_").arg(player))
+        && !line.contains(QString("cmw %1 ").arg(player))) {
+        return false;
+    }
+
+    const QString key = keyFilter->text().trimmed();
+    return key.isEmpty() || line.contains(key, Qt::CaseInsensitive);
+}
+
+QStringList HookLogPane::bufferedLines() const
+{
+    QStringList lines;
+    lines.reserve(ringCount);
+    for (int i = 0; i < ringCount; ++i)
+        lines.append(ring.at((ringHead + i) % ring.size()));
+    return lines;
+}
+
+void HookLogPane::saveTrace()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save QMamehook Trace"), "qmamehook-trace.log",
+                                                          tr("Log Files (*.log *.txt);;All Files (*)"),
+                                                          nullptr, QFileDialog::DontUseNativeDialog);
+    if (fileName.isEmpty())
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Failed to save trace to:" << fileName;
+        return;
+    }
+
+    QTextStream out(&file);
+    for (const QString &line : bufferedLines())
+        out << line << '\n';
+    if (!partialLine.isEmpty())
+        out << partialLine << '\n';
+}
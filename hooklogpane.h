@@ -0,0 +1,59 @@
+#ifndef HOOKLOGPANE_H
+#define HOOKLOGPANE_H
+
+#include <QWidget>
+#include <QStringList>
+#include <QVector>
+
+class QComboBox;
+class QLineEdit;
+class QPlainTextEdit;
+class QTimer;
+
+// Live view of QMamehook's output. Lines are kept in a fixed-size ring
+// buffer and pushed to the view in timed batches, so a chatty hooker
+// cannot flood the GUI thread. The output is either passed in directly or
+// read from the log file a detached QMamehook writes.
+class HookLogPane : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HookLogPane(int capacity = 20000, QWidget *parent = nullptr);
+
+public slots:
+    void appendOutput(const QByteArray &data);
+    void appendLine(const QString &line);
+    void clear();
+    // Shows what is written to path from now on, instead of any earlier file
+    void follow(const QString &path);
+
+private slots:
+    void flushPending();
+    void rebuildView();
+    void saveTrace();
+    void readFollowed();
+
+private:
+    bool matchesFilter(const QString &line) const;
+    QStringList bufferedLines() const;
+
+    // Ring buffer of the most recent lines.
+    QVector<QString> ring;
+    int ringHead = 0;   // index of the oldest line
+    int ringCount = 0;
+
+    QStringList pending;  // received but not yet shown
+    QString partialLine;  // trailing text without a newline yet
+
+    QString followedPath;     // log file being tailed, empty when none
+    qint64 followOffset = 0;  // bytes of it already shown
+
+    QPlainTextEdit *view;
+    QComboBox *playerFilter;
+    QLineEdit *keyFilter;
+    QTimer *flushTimer;
+    QTimer *followTimer;
+};
+
+#endif // HOOKLOGPANE_H
@@ -0,0 +1,74 @@
+#include "inidocument.h"
+
+IniDocument::IniDocument(const QString &content)
+    : lines(content.split('\n'))
+{
+}
+
+IniDocument IniDocument::parse(const QString &content)
+{
+    return IniDocument(content);
+}
+
+QString IniDocument::serialize() const
+{
+    return lines.join('\n');
+}
+
+int IniDocument::sectionHeader(const QString &name) const
+{
+    const QString header = '[' + name + ']';
+    for (int i = 0; i < lines.size(); ++i) {
+        if (lines.at(i).trimmed() == header)
+            return i;
+    }
+    return -1;
+}
+
+bool IniDocument::sectionRange(const QString &name, int &begin, int &end) const
+{
+    const int header = sectionHeader(name);
+    if (header < 0)
+        return false;
+
+    begin = header + 1;
+    end = begin;
+    while (end < lines.size() && !lines.at(end).trimmed().startsWith('['))
+        ++end;
+    return true;
+}
+
+int IniDocument::findLineStartingWith(const QString &prefix, int from) const
+{
+    for (int i = qMax(0, from); i < lines.size(); ++i) {
+        if (lines.at(i).startsWith(prefix))
+            return i;
+    }
+    return -1;
+}
+
+bool IniDocument::replaceLineStartingWith(const QString &prefix, const QString &newLine)
+{
+    const int index = findLineStartingWith(prefix);
+    if (index < 0)
+        return false;
+    lines[index] = newLine;
+    return true;
+}
+
+QString IniDocument::value(const QString &section, const QString &key) const
+{
+    int begin, end;
+    if (!sectionRange(section, begin, end))
+        return QString();
+
+    for (int i = begin; i < end; ++i) {
+        const QString &text = lines.at(i);
+        const int eq = text.indexOf('=');
+        if (eq < 0)
+            continue;
+        if (QStringView(text).left(eq).trimmed() == key)
+            return text.mid(eq + 1).trimmed();
+    }
+    return QString();
+}
@@ -0,0 +1,42 @@
+#ifndef INIDOCUMENT_H
+#define INIDOCUMENT_H
+
+#include <QString>
+#include <QStringList>
+
+// Line-oriented view of a QMamehook ini. Lines are kept verbatim so that
+// serialize() reproduces the input exactly when nothing was modified.
+class IniDocument
+{
+public:
+    IniDocument() = default;
+    explicit IniDocument(const QString &content);
+
+    static IniDocument parse(const QString &content);
+    QString serialize() const;
+
+    int lineCount() const { return lines.size(); }
+    const QString &line(int index) const { return lines.at(index); }
+    void setLine(int index, const QString &text) { lines[index] = text; }
+    void insertLine(int index, const QString &text) { lines.insert(index, text); }
+    void appendLine(const QString &text) { lines.append(text); }
+    void removeLine(int index) { lines.removeAt(index); }
+
+    // Index of the "[name]" header line, or -1.
+    int sectionHeader(const QString &name) const;
+    // First line after the section header and the line of the next header
+    // (or lineCount()). Returns false when the section does not exist.
+    bool sectionRange(const QString &name, int &begin, int &end) const;
+
+    // First line starting with prefix (raw, as in "P1_CtmRecoil"), or -1.
+    int findLineStartingWith(const QString &prefix, int from = 0) const;
+    // Replaces the first line starting with prefix; false when there is none.
+    bool replaceLineStartingWith(const QString &prefix, const QString &newLine);
+
+    // Value of "key = value" inside a section, trimmed; null when missing.
+    QString value(const QString &section, const QString &key) const;
+
+    QStringList lines;
+};
+
+#endif // INIDOCUMENT_H
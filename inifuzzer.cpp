@@ -0,0 +1,29 @@
+// libFuzzer entry point for the ini parsers. Build with -DDSQ_BUILD_FUZZER=ON
+// (clang) and run, for example:
+//   dsq_ini_fuzzer -timeout=1 -max_len=65536 corpus/ tests/fuzz/corpus tests/roundtrip/corpus
+// A hang or slow input is reported as a timeout by libFuzzer. tests/fuzz/corpus
+// holds seeds for inputs that were once slow, such as a line repeating
+// "MameStart=" thousands of times.
+#include "inidocument.h"
+#include "openfireconfig.h"
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const QString content = QString::fromUtf8(reinterpret_cast<const char *>(data), int(size));
+
+    const OpenFireSettings settings = OpenFireConfig::parse(content);
+    const QString applied = OpenFireConfig::apply(content, settings);
+    OpenFireConfig::parse(applied);
+
+    for (int player = 1; player <= 4; ++player)
+        OpenFireConfig::lmpStartColor(content, player);
+    OpenFireConfig::setOutputForAllPlayers(content, "CtmRecoil", "F0x2x1");
+
+    // Serialization must reproduce the input byte for byte.
+    if (IniDocument(content).serialize() != content)
+        __builtin_trap();
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "inihistory.h"
+
+IniHistory::IniHistory(int maxSteps)
+    : maxSteps(qMax(1, maxSteps))
+{
+}
+
+void IniHistory::reset(const QString &text)
+{
+    lines = text.split('\n');
+    steps.clear();
+    position = 0;
+}
+
+IniHistory::Patch IniHistory::diff(const QStringList &before, const QStringList &after)
+{
+    const int shorter = qMin(before.size(), after.size());
+    int prefix = 0;
+    while (prefix < shorter && before.at(prefix) == after.at(prefix))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < shorter - prefix
+           && before.at(before.size() - 1 - suffix) == after.at(after.size() - 1 - suffix))
+        ++suffix;
+
+    Patch patch;
+    patch.firstLine = prefix;
+    patch.removedLines = before.size() - prefix - suffix;
+    patch.insertedLines = after.mid(prefix, after.size() - prefix - suffix);
+    return patch;
+}
+
+void IniHistory::replace(QStringList &lines, int firstLine, int count, const QStringList &with)
+{
+    // Overwrite in place where the block sizes overlap, then grow or shrink
+    const int common = qMin(count, int(with.size()));
+    for (int i = 0; i < common; ++i)
+        lines[firstLine + i] = with.at(i);
+    if (count > common) {
+        const auto begin = lines.begin() + firstLine + common;
+        lines.erase(begin, begin + (count - common));
+    }
+    for (int i = common; i < with.size(); ++i)
+        lines.insert(firstLine + i, with.at(i));
+}
+
+void IniHistory::record(const QString &text)
+{
+    const QStringList next = text.split('\n');
+    const Patch patch = diff(lines, next);
+    if (patch.isEmpty())
+        return;
+
+    push({patch.firstLine, lines.mid(patch.firstLine, patch.removedLines), patch.insertedLines});
+    lines = next;
+}
+
+bool IniHistory::recordLine(int line, const QString &before, const QString &after)
+{
+    if (line < 0 || line >= lines.size() || lines.at(line) != before)
+        return false;
+    if (before != after) {
+        push({line, {before}, {after}});
+        lines[line] = after;
+    }
+    return true;
+}
+
+void IniHistory::push(const Step &step)
+{
+    steps.erase(steps.begin() + position, steps.end());
+    steps.append(step);
+    if (steps.size() > maxSteps)
+        steps.removeFirst();
+    position = steps.size();
+}
+
+bool IniHistory::undo()
+{
+    if (!canUndo())
+        return false;
+    const Step &step = steps.at(--position);
+    replace(lines, step.firstLine, step.inserted.size(), step.removed);
+    return true;
+}
+
+bool IniHistory::redo()
+{
+    if (!canRedo())
+        return false;
+    const Step &step = steps.at(position++);
+    replace(lines, step.firstLine, step.removed.size(), step.inserted);
+    return true;
+}
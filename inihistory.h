@@ -0,0 +1,66 @@
+#ifndef INIHISTORY_H
+#define INIHISTORY_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Undo/redo for the structured edits the OpenFIRE tab makes to the loaded
+// ini. The current document is kept as lines; each step stores only the
+// block of lines it replaced and the block that replaced it, so a history
+// of colour and output changes costs a few lines per step rather than a
+// copy of the file. Stored lines are implicitly shared QStrings.
+class IniHistory
+{
+public:
+    // One contiguous block replacement: removedLines lines starting at
+    // firstLine become insertedLines.
+    struct Patch
+    {
+        int firstLine = 0;
+        int removedLines = 0;
+        QStringList insertedLines;
+        bool isEmpty() const { return removedLines == 0 && insertedLines.isEmpty(); }
+    };
+
+    explicit IniHistory(int maxSteps = 200);
+
+    // Starts over with text as the document and no steps.
+    void reset(const QString &text);
+    // Records the change from the current document to text; no-op when equal.
+    // Drops any steps that were undone.
+    void record(const QString &text);
+    // Records a change to one line without comparing the whole document.
+    // False, and nothing recorded, when that line does not currently read before.
+    bool recordLine(int line, const QString &before, const QString &after);
+
+    bool canUndo() const { return position > 0; }
+    bool canRedo() const { return position < steps.size(); }
+    bool undo();
+    bool redo();
+
+    QString text() const { return lines.join('\n'); }
+    int stepCount() const { return steps.size(); }
+
+    // The smallest single block that turns before into after (common
+    // prefix and suffix lines are left alone).
+    static Patch diff(const QStringList &before, const QStringList &after);
+
+private:
+    struct Step
+    {
+        int firstLine;
+        QStringList removed;
+        QStringList inserted;
+    };
+
+    static void replace(QStringList &lines, int firstLine, int count, const QStringList &with);
+    void push(const Step &step);
+
+    int maxSteps;
+    QStringList lines;
+    QList<Step> steps;
+    int position = 0; // steps before this index are applied
+};
+
+#endif // INIHISTORY_H
@@ -0,0 +1,162 @@
+#include "iniindex.h"
+#include "dsqlogging.h"
+#include "dsqtrace.h"
+#include "emulatorutils.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+
+// Bump when Entry changes so stale caches are rebuilt rather than misread.
+static const int cacheVersion = 1;
+
+QString IniIndex::cachePathFor(const QString &settingsPath)
+{
+    return QFileInfo(settingsPath).absoluteDir().filePath("ini-index.json");
+}
+
+IniIndex::Entry IniIndex::parseFile(const QString &path, const QString &fileName, qint64 size, qint64 modifiedMs)
+{
+    const OpenFireSettings settings = OpenFireConfig::parse(EmulatorUtils::loadIniContent(path));
+
+    Entry entry;
+    entry.fileName = fileName;
+    entry.size = size;
+    entry.modifiedMs = modifiedMs;
+    entry.playerCount = settings.playerCount;
+    entry.startCommand = settings.startCommand;
+    entry.modeFlags = settings.modeFlags();
+    for (const QString &key : settings.presentSettings)
+        entry.outputs.insert(key, settings.outputValue(key));
+    entry.ledColors = settings.ledColors;
+    return entry;
+}
+
+int IniIndex::refresh(const QString &dirPath)
+{
+    DSQ_TRACE_SPAN("IniIndex::refresh");
+    const QString absolute = QDir(dirPath).absolutePath();
+    if (absolute != iniDir) {
+        files.clear();
+        iniDir = absolute;
+    }
+
+    const QFileInfoList infos = QDir(iniDir).entryInfoList({"*.ini"}, QDir::Files, QDir::Name);
+
+    QHash<QString, Entry> current;
+    QList<QFileInfo> stale;
+    for (const QFileInfo &info : infos) {
+        const qint64 modifiedMs = info.lastModified().toMSecsSinceEpoch();
+        auto cached = files.constFind(info.fileName());
+        if (cached != files.constEnd() && cached->size == info.size() && cached->modifiedMs == modifiedMs)
+            current.insert(info.fileName(), cached.value());
+        else
+            stale.append(info);
+    }
+
+    // Reparse what changed in parallel; each task fills its own slot
+    QVector<Entry> parsed(stale.size());
+    QThreadPool pool;
+    for (int i = 0; i < stale.size(); ++i) {
+        const QFileInfo info = stale[i];
+        Entry *slot = &parsed[i];
+        pool.start([info, slot]() {
+            *slot = parseFile(info.filePath(), info.fileName(), info.size(),
+                              info.lastModified().toMSecsSinceEpoch());
+        });
+    }
+    pool.waitForDone();
+
+    const int removed = files.size() - current.size();
+    for (const Entry &entry : parsed)
+        current.insert(entry.fileName, entry);
+    files = current;
+
+    qCDebug(lcIni) << "Ini index:" << files.size() << "files," << parsed.size() << "reparsed," << removed << "gone";
+    return parsed.size() + removed;
+}
+
+QList<IniIndex::Entry> IniIndex::entries() const
+{
+    QList<Entry> sorted = files.values();
+    std::sort(sorted.begin(), sorted.end(), [](const Entry &a, const Entry &b) {
+        return a.fileName < b.fileName;
+    });
+    return sorted;
+}
+
+bool IniIndex::load(const QString &cachePath)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != cacheVersion)
+        return false;
+
+    iniDir = root.value("directory").toString();
+    files.clear();
+    const QJsonObject entries = root.value("files").toObject();
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        Entry entry;
+        entry.fileName = it.key();
+        entry.size = qint64(object.value("size").toDouble());
+        entry.modifiedMs = qint64(object.value("modified").toDouble());
+        entry.playerCount = object.value("players").toInt(1);
+        entry.startCommand = object.value("start").toString();
+        for (const QJsonValue &flag : object.value("modes").toArray())
+            entry.modeFlags << flag.toString();
+        const QJsonObject outputs = object.value("outputs").toObject();
+        for (auto output = outputs.constBegin(); output != outputs.constEnd(); ++output)
+            entry.outputs.insert(output.key(), output.value().toString());
+        const QJsonArray colors = object.value("colors").toArray();
+        for (int i = 0; i < 4 && i < colors.size(); ++i) {
+            const QJsonArray rgb = colors[i].toArray();
+            if (rgb.size() == 3)
+                entry.ledColors[i] = {rgb[0].toInt(), rgb[1].toInt(), rgb[2].toInt()};
+        }
+        files.insert(entry.fileName, entry);
+    }
+    return true;
+}
+
+bool IniIndex::save(const QString &cachePath) const
+{
+    QJsonObject entries;
+    for (const Entry &entry : files) {
+        QJsonObject object;
+        object["size"] = double(entry.size);
+        object["modified"] = double(entry.modifiedMs);
+        object["players"] = entry.playerCount;
+        object["start"] = entry.startCommand;
+        object["modes"] = QJsonArray::fromStringList(entry.modeFlags);
+        QJsonObject outputs;
+        for (auto it = entry.outputs.constBegin(); it != entry.outputs.constEnd(); ++it)
+            outputs[it.key()] = it.value();
+        object["outputs"] = outputs;
+        QJsonArray colors;
+        for (const LedColor &color : entry.ledColors)
+            colors.append(color.isValid() ? QJsonArray{color.red, color.green, color.blue} : QJsonArray());
+        object["colors"] = colors;
+        entries[entry.fileName] = object;
+    }
+
+    QJsonObject root;
+    root["version"] = cacheVersion;
+    root["directory"] = iniDir;
+    root["files"] = entries;
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
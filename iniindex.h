@@ -0,0 +1,52 @@
+#ifndef INIINDEX_H
+#define INIINDEX_H
+
+#include "openfireconfig.h"
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <array>
+
+// What each ini in a QMamehook ini folder configures, kept in a small JSON
+// cache so overviews don't have to re-read every file. refresh() only
+// reparses files whose size or modification time changed since the cache
+// was written. A value type: build or refresh a copy on a worker thread and
+// hand it back.
+class IniIndex
+{
+public:
+    struct Entry
+    {
+        QString fileName;
+        qint64 size = 0;
+        qint64 modifiedMs = 0;
+        int playerCount = 1;
+        QString startCommand;
+        QStringList modeFlags;
+        QMap<QString, QString> outputs; // player 1 payload per output key
+        std::array<LedColor, 4> ledColors;
+    };
+
+    // cache file next to settings.ini
+    static QString cachePathFor(const QString &settingsPath);
+
+    bool load(const QString &cachePath);
+    bool save(const QString &cachePath) const;
+
+    // Brings the index in line with iniDir; returns how many entries were
+    // added, reparsed or dropped (0 when the cache was already current).
+    int refresh(const QString &iniDir);
+
+    QString directory() const { return iniDir; }
+    QList<Entry> entries() const;
+
+private:
+    static Entry parseFile(const QString &path, const QString &fileName, qint64 size, qint64 modifiedMs);
+
+    QString iniDir;
+    QHash<QString, Entry> files;
+};
+
+#endif // INIINDEX_H
@@ -0,0 +1,427 @@
+#include "launchdaemon.h"
+#include "dsqlogging.h"
+#include "emulatorutils.h"
+#include "exportcache.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QProcess>
+#include <QTimer>
+
+// How long after a launch new processes still count as started by it.
+static const int claimWindowMs = 30000;
+static const int claimPollMs = 1000;
+static const int scanTimeoutMs = 5000;
+
+static void startProcessList(QProcess *list)
+{
+#ifdef Q_OS_WIN
+    // "image.exe","1234","Console","1","10,000 K"
+    list->start("tasklist", {"/FO", "CSV", "/NH"});
+#else
+    list->start("ps", {"-A", "-o", "pid=", "-o", "comm="});
+#endif
+}
+
+// The process list's output as pid -> executable file name.
+static QHash<qint64, QString> parseProcessList(const QByteArray &output)
+{
+    QHash<qint64, QString> processes;
+    const QList<QByteArray> lines = output.split('\n');
+    for (const QByteArray &rawLine : lines) {
+        const QString line = QString::fromLocal8Bit(rawLine).trimmed();
+        if (line.isEmpty())
+            continue;
+#ifdef Q_OS_WIN
+        const QStringList fields = line.split(QLatin1String("\",\""));
+        if (fields.size() < 2)
+            continue;
+        QString image = fields.at(0);
+        image.remove('"');
+        bool ok = false;
+        const qint64 pid = fields.at(1).toLongLong(&ok);
+#else
+        const int space = int(line.indexOf(' '));
+        if (space < 0)
+            continue;
+        bool ok = false;
+        const qint64 pid = line.left(space).toLongLong(&ok);
+        const QString image = QFileInfo(line.mid(space + 1).trimmed()).fileName();
+#endif
+        if (ok)
+            processes.insert(pid, image);
+    }
+    return processes;
+}
+
+LaunchDaemon::LaunchDaemon(CatalogResolver catalog, PlanResolver resolver,
+                           const QString &settingsPath, QObject *parent)
+    : QObject(parent),
+      catalog(std::move(catalog)),
+      resolver(std::move(resolver)),
+      settingsPath(settingsPath),
+      server(new QLocalServer(this)),
+      claimTimer(new QTimer(this))
+{
+    connect(server, &QLocalServer::newConnection, this, &LaunchDaemon::acceptConnection);
+    // Emulators can take a while to appear after the bat has started them
+    claimTimer->setInterval(claimPollMs);
+    connect(claimTimer, &QTimer::timeout, this, [this]() {
+        scanProcesses([this](const ProcessList &running) { claimStartedProcesses(running); });
+        if (QDateTime::currentMSecsSinceEpoch() - activeSince >= claimWindowMs)
+            claimTimer->stop();
+    });
+    loadPlans();
+}
+
+QString LaunchDaemon::defaultServerName()
+{
+    return QStringLiteral("DemulEASY-launcher");
+}
+
+QString LaunchDaemon::planKey(const QString &emulator, const QString &game)
+{
+    return emulator + QLatin1Char('\n') + game;
+}
+
+bool LaunchDaemon::listen(const QString &serverName)
+{
+    // A crashed daemon can leave a stale socket behind on Unix.
+    QLocalServer::removeServer(serverName);
+    return server->listen(serverName);
+}
+
+QString LaunchDaemon::errorString() const
+{
+    return server->errorString();
+}
+
+void LaunchDaemon::loadPlans()
+{
+    plans.clear();
+    romIndex.clear();
+    for (const LaunchPlan &plan : catalog()) {
+        const QString key = planKey(plan.emulator, plan.game);
+        plans.insert(key, plan);
+        // First emulator listed wins for a bare ROM code (e.g. Demul before Flycast).
+        if (!romIndex.contains(plan.romCode))
+            romIndex.insert(plan.romCode, key);
+    }
+}
+
+void LaunchDaemon::acceptConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            replyQueues.remove(socket);
+            socket->deleteLater();
+        });
+        replyQueues.insert(socket, ReplyQueue());
+    }
+}
+
+void LaunchDaemon::readRequests(QLocalSocket *socket)
+{
+    // Replies that are ready before the last line is read go out in one write.
+    readingSocket = socket;
+    const QPointer<QLocalSocket> client(socket);
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        const qint64 sequence = replyQueues[socket].nextSequence++;
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            sendReply(socket, sequence, {{"ok", false}, {"error", "malformed request"}});
+            continue;
+        }
+
+        const QJsonObject request = doc.object();
+        const QJsonValue id = request.value("id");
+        handleRequest(request, [this, client, sequence, id](const QJsonObject &reply) {
+            QJsonObject tagged = reply;
+            if (!id.isUndefined())
+                tagged.insert("id", id);
+            sendReply(client, sequence, tagged);
+        });
+    }
+    readingSocket = nullptr;
+    flushReplies(socket);
+}
+
+void LaunchDaemon::sendReply(QLocalSocket *socket, qint64 sequence, const QJsonObject &reply)
+{
+    // The client may have hung up while its request waited for a process scan
+    if (!socket || !replyQueues.contains(socket))
+        return;
+    replyQueues[socket].ready.insert(sequence, QJsonDocument(reply).toJson(QJsonDocument::Compact) + '\n');
+    if (socket != readingSocket)
+        flushReplies(socket);
+}
+
+void LaunchDaemon::flushReplies(QLocalSocket *socket)
+{
+    if (!replyQueues.contains(socket))
+        return;
+    ReplyQueue &queue = replyQueues[socket];
+    QByteArray replies;
+    while (!queue.ready.isEmpty() && queue.ready.firstKey() == queue.nextToWrite)
+        replies += queue.ready.take(queue.nextToWrite++);
+    if (!replies.isEmpty())
+        socket->write(replies);
+}
+
+QString LaunchDaemon::findPlanKey(const QJsonObject &request) const
+{
+    const QString rom = request.value("rom").toString();
+    if (!rom.isEmpty())
+        return romIndex.value(rom);
+
+    const QString key = planKey(request.value("emulator").toString(), request.value("game").toString());
+    return plans.contains(key) ? key : QString();
+}
+
+void LaunchDaemon::handleRequest(const QJsonObject &request, const Reply &reply)
+{
+    const QString cmd = request.value("cmd").toString();
+
+    if (cmd == "ping") {
+        reply({{"ok", true}});
+        return;
+    }
+    if (cmd == "status") {
+        status(reply);
+        return;
+    }
+    if (cmd == "stop") {
+        stop(request.value("dryRun").toBool(), reply);
+        return;
+    }
+    if (cmd == "reload") {
+        loadPlans();
+        if (!plans.contains(activeKey)) {
+            activeKey.clear();
+            startedPids.clear();
+            claimTimer->stop();
+        }
+        reply({{"ok", true}, {"plans", int(plans.size())}});
+        return;
+    }
+
+    if (cmd == "launch" || cmd == "plan") {
+        const QString key = findPlanKey(request);
+        if (key.isEmpty()) {
+            reply({{"ok", false}, {"error", "unknown game"}});
+            return;
+        }
+        if (cmd == "launch") {
+            launch(key, request.value("dryRun").toBool(), reply);
+            return;
+        }
+
+        const LaunchPlan &plan = *plans.constFind(key);
+        reply({{"ok", true}, {"rom", plan.romCode}, {"emulator", plan.emulator},
+               {"game", plan.game}, {"bat", plan.batContent}});
+        return;
+    }
+
+    reply({{"ok", false}, {"error", QString("unknown command: %1").arg(cmd)}});
+}
+
+// Lists the running processes without waiting for the list; requests that
+// arrive while one is being read share it.
+void LaunchDaemon::scanProcesses(const ScanDone &done)
+{
+    scanWaiters.append(done);
+    if (scan)
+        return;
+
+    QProcess *list = new QProcess(this);
+    scan = list;
+    connect(list, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, list]() {
+        finishScan(parseProcessList(list->readAllStandardOutput()));
+    });
+    connect(list, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        // finished() never comes for a list that could not start
+        if (error == QProcess::FailedToStart) {
+            qCWarning(lcLaunch) << "Could not list running processes";
+            finishScan({});
+        }
+    });
+    // A hung list ends with whatever it printed so far
+    QTimer::singleShot(scanTimeoutMs, list, [list]() { list->kill(); });
+    startProcessList(list);
+}
+
+void LaunchDaemon::finishScan(const ProcessList &running)
+{
+    scan->deleteLater();
+    scan = nullptr;
+    const QList<ScanDone> waiters = std::move(scanWaiters);
+    scanWaiters.clear();
+    for (const ScanDone &done : waiters)
+        done(running);
+}
+
+void LaunchDaemon::launch(const QString &key, bool dryRun, const Reply &reply)
+{
+    LaunchPlan &plan = plans[key];
+
+    // Only touch the disk when the exported files no longer match the plan.
+    ExportCache exportCache(settingsPath);
+    const bool current = exportCache.isCurrent(plan.romCode, plan.fingerprint, plan.iniFilePath, plan.batFilePath);
+    if (!dryRun && !current) {
+        // Someone may have edited the ini since startup; re-resolve before writing.
+        plan = resolver(plan.emulator, plan.game);
+        if (!exportCache.isCurrent(plan.romCode, plan.fingerprint, plan.iniFilePath, plan.batFilePath)
+            && !EmulatorUtils::createFiles(plan.game, plan.qmamehookerPath, plan.iniContent,
+                                           plan.batContent, settingsPath)) {
+            reply({{"ok", false}, {"error", "export failed"}, {"rom", plan.romCode}});
+            return;
+        }
+    }
+
+    // Whatever is running now was not started by this launch
+    scanProcesses([this, key, dryRun, current, reply](const ProcessList &before) {
+        const auto found = plans.constFind(key);
+        if (found == plans.constEnd()) {
+            // A reload dropped the game while the list was read
+            reply({{"ok", false}, {"error", "unknown game"}});
+            return;
+        }
+        const LaunchPlan &plan = *found;
+
+        if (dryRun) {
+            // The plan's processes that are already up and would not be claimed
+            QJsonArray running;
+            for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+                if (plan.processImages.contains(it.value(), Qt::CaseInsensitive))
+                    running.append(it.key());
+            }
+            reply({{"ok", true}, {"state", "dry-run"}, {"rom", plan.romCode},
+                   {"export", current ? "current" : "stale"}, {"running", running}});
+            return;
+        }
+
+        if (!EmulatorUtils::launchBatch(plan.batFilePath)) {
+            reply({{"ok", false}, {"error", "launch failed"}, {"rom", plan.romCode}});
+            return;
+        }
+
+        runningBeforeLaunch = QSet<qint64>(before.keyBegin(), before.keyEnd());
+        startedPids.clear();
+        activeKey = key;
+        activeSince = QDateTime::currentMSecsSinceEpoch();
+        claimTimer->start();
+        qCDebug(lcLaunch) << "Daemon launched" << plan.game;
+        reply({{"ok", true}, {"state", "running"}, {"rom", plan.romCode}});
+    });
+}
+
+// Adds the plan's processes in running that appeared since the launch (within
+// claimWindowMs of it) to startedPids; returns the claimed ones still running.
+QList<qint64> LaunchDaemon::claimStartedProcesses(const ProcessList &running)
+{
+    if (activeKey.isEmpty())
+        return {};
+    const LaunchPlan &plan = *plans.constFind(activeKey);
+    const bool claiming = QDateTime::currentMSecsSinceEpoch() - activeSince < claimWindowMs;
+
+    QList<qint64> alive;
+    for (auto it = running.constBegin(); it != running.constEnd(); ++it) {
+        if (claiming && !runningBeforeLaunch.contains(it.key())
+            && plan.processImages.contains(it.value(), Qt::CaseInsensitive))
+            startedPids.insert(it.key());
+        if (startedPids.contains(it.key()))
+            alive.append(it.key());
+    }
+    return alive;
+}
+
+void LaunchDaemon::stop(bool dryRun, const Reply &reply)
+{
+    if (activeKey.isEmpty()) {
+        reply({{"ok", true}, {"state", "idle"}});
+        return;
+    }
+
+    const QString key = activeKey;
+    scanProcesses([this, key, dryRun, reply](const ProcessList &running) {
+        // An earlier stop or a reload may have ended the game during the scan
+        if (activeKey != key) {
+            reply({{"ok", true}, {"state", "idle"}});
+            return;
+        }
+
+        const QList<qint64> pids = claimStartedProcesses(running);
+        QJsonArray stopped;
+        for (qint64 pid : pids)
+            stopped.append(pid);
+        const QString rom = plans.constFind(activeKey)->romCode;
+        if (dryRun) {
+            reply({{"ok", true}, {"state", "dry-run"}, {"rom", rom}, {"pids", stopped}});
+            return;
+        }
+
+        if (!pids.isEmpty()) {
+#ifdef Q_OS_WIN
+            QStringList arguments{"/F"};
+            for (qint64 pid : pids)
+                arguments << "/PID" << QString::number(pid);
+            QProcess::startDetached("taskkill", arguments);
+#else
+            QStringList arguments;
+            for (qint64 pid : pids)
+                arguments << QString::number(pid);
+            QProcess::startDetached("kill", arguments);
+#endif
+        }
+
+        activeKey.clear();
+        activeSince = 0;
+        startedPids.clear();
+        claimTimer->stop();
+        reply({{"ok", true}, {"state", "idle"}, {"rom", rom}, {"pids", stopped}});
+    });
+}
+
+void LaunchDaemon::status(const Reply &reply)
+{
+    if (activeKey.isEmpty()) {
+        reply({{"ok", true}, {"plans", int(plans.size())}, {"state", "idle"}});
+        return;
+    }
+
+    scanProcesses([this, reply](const ProcessList &running) {
+        QJsonObject result{{"ok", true}, {"plans", int(plans.size())}};
+        if (activeKey.isEmpty()) {
+            result.insert("state", "idle");
+            reply(result);
+            return;
+        }
+
+        // "starting" until a process shows up, "exited" once they have all gone
+        const QList<qint64> pids = claimStartedProcesses(running);
+        QJsonArray alive;
+        for (qint64 pid : pids)
+            alive.append(pid);
+        const LaunchPlan &plan = *plans.constFind(activeKey);
+        if (!pids.isEmpty())
+            result.insert("state", "running");
+        else
+            result.insert("state", claimTimer->isActive() && startedPids.isEmpty() ? "starting" : "exited");
+        result.insert("emulator", plan.emulator);
+        result.insert("game", plan.game);
+        result.insert("rom", plan.romCode);
+        result.insert("since", activeSince);
+        result.insert("pids", alive);
+        reply(result);
+    });
+}
@@ -0,0 +1,99 @@
+#ifndef LAUNCHDAEMON_H
+#define LAUNCHDAEMON_H
+
+#include "launchplan.h"
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <functional>
+
+class QLocalServer;
+class QLocalSocket;
+class QProcess;
+class QTimer;
+
+// Resident launcher for front-ends. Listens on a local socket and answers
+// newline-delimited JSON requests from plans held in memory:
+//   {"id":1,"cmd":"launch","emulator":"Demul 0.7a","game":"Confidential Mission"}
+//   {"id":2,"cmd":"launch","rom":"confmiss"}
+//   {"id":3,"cmd":"stop"}   {"id":4,"cmd":"status"}   {"id":5,"cmd":"plan","rom":"hotd2"}
+//   {"id":6,"cmd":"ping"}   {"id":7,"cmd":"reload"}
+// "launch" and "stop" take "dryRun":true to report what they would do
+// without writing, launching or killing anything.
+//
+// The bat detaches everything it starts, so after a launch the daemon looks
+// for processes named in the plan that were not running beforehand and
+// claims those; "stop" only ends claimed processes and "status" reports
+// whether any of them is still alive. The process list is read without
+// blocking the event loop, so other clients are answered meanwhile; each
+// connection still gets its replies in request order.
+class LaunchDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    using PlanResolver = std::function<LaunchPlan(const QString &emulator, const QString &game)>;
+    using CatalogResolver = std::function<QList<LaunchPlan>()>;
+
+    LaunchDaemon(CatalogResolver catalog, PlanResolver resolver,
+                 const QString &settingsPath, QObject *parent = nullptr);
+
+    bool listen(const QString &serverName);
+    QString errorString() const;
+    int planCount() const { return plans.size(); }
+
+    static QString defaultServerName();
+    static QString planKey(const QString &emulator, const QString &game);
+
+private slots:
+    void acceptConnection();
+
+private:
+    using Reply = std::function<void(const QJsonObject &reply)>;
+    using ProcessList = QHash<qint64, QString>;   // pid -> executable file name
+    using ScanDone = std::function<void(const ProcessList &running)>;
+
+    // Replies of one connection, held back until the earlier ones are written
+    struct ReplyQueue
+    {
+        qint64 nextSequence = 0;   // given to the next request read
+        qint64 nextToWrite = 0;
+        QMap<qint64, QByteArray> ready;
+    };
+
+    void loadPlans();
+    void readRequests(QLocalSocket *socket);
+    void sendReply(QLocalSocket *socket, qint64 sequence, const QJsonObject &reply);
+    void flushReplies(QLocalSocket *socket);
+    void handleRequest(const QJsonObject &request, const Reply &reply);
+    void launch(const QString &key, bool dryRun, const Reply &reply);
+    void stop(bool dryRun, const Reply &reply);
+    void status(const Reply &reply);
+    void scanProcesses(const ScanDone &done);
+    void finishScan(const ProcessList &running);
+    QList<qint64> claimStartedProcesses(const ProcessList &running);
+    QString findPlanKey(const QJsonObject &request) const;
+
+    CatalogResolver catalog;
+    PlanResolver resolver;
+    QString settingsPath;
+    QLocalServer *server;
+
+    QHash<QString, LaunchPlan> plans;   // planKey() -> plan
+    QHash<QString, QString> romIndex;   // rom code -> planKey()
+    QString activeKey;                  // last launched game, empty when idle
+    qint64 activeSince = 0;
+    QSet<qint64> runningBeforeLaunch;   // pids that existed when it was launched
+    QSet<qint64> startedPids;           // plan processes that appeared since
+    QTimer *claimTimer;
+
+    QHash<QLocalSocket *, ReplyQueue> replyQueues;
+    QLocalSocket *readingSocket = nullptr;  // its replies are batched until the read ends
+    QProcess *scan = nullptr;               // process listing in flight
+    QList<ScanDone> scanWaiters;            // requests sharing that listing
+};
+
+#endif // LAUNCHDAEMON_H
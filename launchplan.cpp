@@ -0,0 +1,74 @@
+#include "launchplan.h"
+#include "bulkedit.h"
+#include "configlayers.h"
+#include "emulatorutils.h"
+#include "exportcache.h"
+#include <QFileInfo>
+
+static QString emulatorPathFor(const QString &emulator, const LaunchPaths &paths)
+{
+    if (!paths.emulatorPath.isEmpty())
+        return paths.emulatorPath;
+    QString emulatorPath, romPath;
+    EmulatorUtils::updateEmulatorPath(emulator, emulatorPath, romPath);
+    return emulatorPath;
+}
+
+static QString romPathFor(const QString &emulator, const LaunchPaths &paths)
+{
+    if (!paths.romPath.isEmpty())
+        return paths.romPath;
+    QString emulatorPath, romPath;
+    EmulatorUtils::updateEmulatorPath(emulator, emulatorPath, romPath);
+    return romPath;
+}
+
+// Only real executable names: emulators without a default path give an
+// empty name, and "Windows Games" gives the "Choose path to executable"
+// placeholder.
+static bool isProcessImage(const QString &name)
+{
+    return name.size() > 4 && name.endsWith(QLatin1String(".exe"), Qt::CaseInsensitive);
+}
+
+QString LaunchPlan::generateBat(const QString &emulator, const QString &game, const LaunchPaths &paths)
+{
+    return EmulatorUtils::generateBatContent(game,
+                                             emulator,
+                                             emulatorPathFor(emulator, paths),
+                                             romPathFor(emulator, paths),
+                                             paths.qmamehookerPath,
+                                             paths.demulShooterPath,
+                                             paths.verbose,
+                                             paths.demulShooterArgs);
+}
+
+LaunchPlan LaunchPlan::resolve(const QString &emulator, const QString &game, const LaunchPaths &paths,
+                               const ConfigLayers *layers)
+{
+    LaunchPlan plan;
+    plan.emulator = emulator;
+    plan.game = game;
+    plan.romCode = EmulatorUtils::mapRom(game);
+    plan.qmamehookerPath = paths.qmamehookerPath;
+    EmulatorUtils::exportFilePaths(paths.qmamehookerPath, game, plan.iniFilePath, plan.batFilePath);
+
+    // Keep whatever the user already tuned in the ini; only fill in missing ones.
+    plan.iniContent = EmulatorUtils::loadIniContent(plan.iniFilePath);
+    // The shared layers win, exactly as --apply-layers would write them
+    if (layers)
+        plan.iniContent = BulkEdit::transform(plan.iniContent, layers->resolve(plan.romCode));
+    plan.batContent = generateBat(emulator, game, paths);
+    plan.fingerprint = ExportCache::fingerprint(plan.iniFilePath, plan.batFilePath,
+                                                plan.iniContent, plan.batContent);
+
+    QString mappedEmulator = emulator;
+    QString demulShooterExe;
+    EmulatorUtils::mapEmulator(mappedEmulator, demulShooterExe);
+    for (const QString &image : {QFileInfo(emulatorPathFor(emulator, paths)).fileName(),
+                                 QString("QMamehook.exe"), demulShooterExe}) {
+        if (isProcessImage(image))
+            plan.processImages << image;
+    }
+    return plan;
+}
@@ -0,0 +1,45 @@
+#ifndef LAUNCHPLAN_H
+#define LAUNCHPLAN_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class ConfigLayers;
+
+// Install locations a plan is resolved against. Empty emulator/rom paths
+// fall back to the catalog defaults from EmulatorUtils::updateEmulatorPath.
+struct LaunchPaths
+{
+    QString qmamehookerPath;
+    QString demulShooterPath;
+    QString demulShooterArgs;
+    QString emulatorPath;
+    QString romPath;
+    QString verbose;   // "-v" or empty
+};
+
+// Everything needed to launch one game, resolved ahead of time.
+struct LaunchPlan
+{
+    QString emulator;
+    QString game;
+    QString romCode;
+    QString qmamehookerPath;
+    QString iniFilePath;
+    QString batFilePath;
+    QString iniContent;
+    QString batContent;
+    QByteArray fingerprint;
+    QStringList processImages; // executable names (*.exe) the bat starts
+
+    // Reads the current ini (or the default header), applies only what the
+    // layers set for the game when given (see BulkEdit::transform), and
+    // generates the bat.
+    static LaunchPlan resolve(const QString &emulator, const QString &game, const LaunchPaths &paths,
+                              const ConfigLayers *layers = nullptr);
+    // Just the bat content resolve() would produce.
+    static QString generateBat(const QString &emulator, const QString &game, const LaunchPaths &paths);
+};
+
+#endif // LAUNCHPLAN_H
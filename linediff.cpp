@@ -0,0 +1,180 @@
+#include "linediff.h"
+#include <QHash>
+#include <QVector>
+#include <algorithm>
+
+// An empty file has no lines rather than one empty line.
+static QStringList linesOf(const QString &text)
+{
+    return text.isEmpty() ? QStringList() : text.split('\n');
+}
+
+QList<LineDiff::Edit> LineDiff::compute(const QStringList &before, const QStringList &after)
+{
+    const int oldSize = before.size();
+    const int newSize = after.size();
+
+    int prefix = 0;
+    while (prefix < oldSize && prefix < newSize && before.at(prefix) == after.at(prefix))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < oldSize - prefix && suffix < newSize - prefix
+           && before.at(oldSize - 1 - suffix) == after.at(newSize - 1 - suffix))
+        ++suffix;
+
+    // The middle part, compared by hash first
+    const int n = oldSize - prefix - suffix;
+    const int m = newSize - prefix - suffix;
+    QVector<size_t> a(n), b(m);
+    for (int i = 0; i < n; ++i)
+        a[i] = qHash(before.at(prefix + i));
+    for (int j = 0; j < m; ++j)
+        b[j] = qHash(after.at(prefix + j));
+    auto same = [&](int x, int y) {
+        return a[x] == b[y] && before.at(prefix + x) == after.at(prefix + y);
+    };
+
+    // Forward pass. trace[d] keeps the furthest x on diagonals -d..d after d edits.
+    const int max = n + m;
+    QVector<int> v(2 * max + 3, 0);
+    const int offset = max + 1;
+    QVector<QVector<int>> trace;
+    int edits = 0;
+    for (int d = 0; d <= max; ++d) {
+        bool done = false;
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                        ? v[offset + k + 1]
+                        : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && same(x, y)) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m)
+                done = true;
+        }
+        trace.append(v.mid(offset - d, 2 * d + 1));
+        if (done) {
+            edits = d;
+            break;
+        }
+    }
+
+    // Walk back from the end, collecting the script in reverse
+    QList<Edit> reversed;
+    int x = n;
+    int y = m;
+    for (int d = edits; d > 0; --d) {
+        const QVector<int> &previous = trace.at(d - 1);
+        auto furthest = [&](int k) { return previous.at(k + d - 1); };
+        const int k = x - y;
+        const bool down = k == -d || (k != d && furthest(k - 1) < furthest(k + 1));
+        const int previousK = down ? k + 1 : k - 1;
+        const int previousX = furthest(previousK);
+        const int previousY = previousX - previousK;
+        while (x > previousX && y > previousY) {
+            --x;
+            --y;
+            reversed.append({Op::Equal, prefix + x, prefix + y});
+        }
+        if (down)
+            reversed.append({Op::Insert, prefix + x, prefix + y - 1});
+        else
+            reversed.append({Op::Delete, prefix + x - 1, prefix + y});
+        x = previousX;
+        y = previousY;
+    }
+    while (x > 0 && y > 0) {
+        --x;
+        --y;
+        reversed.append({Op::Equal, prefix + x, prefix + y});
+    }
+
+    QList<Edit> script;
+    script.reserve(prefix + reversed.size() + suffix);
+    for (int i = 0; i < prefix; ++i)
+        script.append({Op::Equal, i, i});
+    for (auto it = reversed.crbegin(); it != reversed.crend(); ++it)
+        script.append(*it);
+    for (int i = 0; i < suffix; ++i)
+        script.append({Op::Equal, oldSize - suffix + i, newSize - suffix + i});
+    return script;
+}
+
+LineDiff::Counts LineDiff::count(const QList<Edit> &edits)
+{
+    Counts counts;
+    for (const Edit &edit : edits) {
+        if (edit.op == Op::Insert)
+            ++counts.added;
+        else if (edit.op == Op::Delete)
+            ++counts.removed;
+    }
+    return counts;
+}
+
+LineDiff::Counts LineDiff::count(const QString &before, const QString &after)
+{
+    if (before == after)
+        return Counts();
+    return count(compute(linesOf(before), linesOf(after)));
+}
+
+QString LineDiff::unified(const QString &before, const QString &after,
+                          const QString &beforeName, const QString &afterName, int context)
+{
+    if (before == after)
+        return QString();
+    const QStringList oldLines = linesOf(before);
+    const QStringList newLines = linesOf(after);
+    const QList<Edit> edits = compute(oldLines, newLines);
+
+    QString out = "--- " + beforeName + "\n+++ " + afterName + '\n';
+    int i = 0;
+    while (i < edits.size()) {
+        while (i < edits.size() && edits[i].op == Op::Equal)
+            ++i;
+        if (i == edits.size())
+            break;
+
+        // Grow the hunk while the next change is within two contexts' reach
+        const int begin = std::max(0, i - context);
+        int lastChange = i;
+        for (int j = i + 1; j < edits.size() && j <= lastChange + 2 * context + 1; ++j) {
+            if (edits[j].op != Op::Equal)
+                lastChange = j;
+        }
+        const int end = std::min(int(edits.size()), lastChange + context + 1);
+
+        int oldCount = 0;
+        int newCount = 0;
+        QString body;
+        for (int j = begin; j < end; ++j) {
+            const Edit &edit = edits[j];
+            switch (edit.op) {
+            case Op::Equal:
+                ++oldCount;
+                ++newCount;
+                body += ' ' + oldLines.at(edit.oldLine) + '\n';
+                break;
+            case Op::Delete:
+                ++oldCount;
+                body += '-' + oldLines.at(edit.oldLine) + '\n';
+                break;
+            case Op::Insert:
+                ++newCount;
+                body += '+' + newLines.at(edit.newLine) + '\n';
+                break;
+            }
+        }
+        // Unified diffs number from 1; an empty side gives the line before it
+        const int oldStart = edits[begin].oldLine + (oldCount ? 1 : 0);
+        const int newStart = edits[begin].newLine + (newCount ? 1 : 0);
+        out += QString("@@ -%1,%2 +%3,%4 @@\n").arg(oldStart).arg(oldCount).arg(newStart).arg(newCount);
+        out += body;
+        i = end;
+    }
+    return out;
+}
@@ -0,0 +1,43 @@
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Line-level diff (Myers' O(ND) algorithm) used to preview exports. Lines
+// shared at the start and end are trimmed off first and the rest compared
+// by hash, so the usual few-line change to an ini costs little more than
+// one pass over it.
+class LineDiff
+{
+public:
+    enum class Op { Equal, Insert, Delete };
+
+    // oldLine/newLine index the inputs; for an Insert oldLine is the
+    // position in before it goes at, for a Delete newLine likewise.
+    struct Edit
+    {
+        Op op;
+        int oldLine;
+        int newLine;
+    };
+
+    struct Counts
+    {
+        int added = 0;
+        int removed = 0;
+        bool isEmpty() const { return added == 0 && removed == 0; }
+    };
+
+    // A shortest edit script from before to after.
+    static QList<Edit> compute(const QStringList &before, const QStringList &after);
+    static Counts count(const QList<Edit> &edits);
+    static Counts count(const QString &before, const QString &after);
+
+    // Unified diff with context lines around each change; empty when equal.
+    static QString unified(const QString &before, const QString &after,
+                           const QString &beforeName, const QString &afterName, int context = 3);
+};
+
+#endif // LINEDIFF_H
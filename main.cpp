@@ -1,11 +1,36 @@
 #include "mainwindow.h"
+#include "headlesscli.h"
+#include "dsqtrace.h"
 #include <QApplication>
+#include <QCoreApplication>
+#include <cstdio>
 
-int main(int argc, char *argv[])
+static int run(int argc, char *argv[])
 {
+    // Scripted use: no widgets, no display needed.
+    if (HeadlessCli::isHeadlessInvocation(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        HeadlessCli cli;
+        return cli.run(a.arguments());
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
     return a.exec();
 }
 
+int main(int argc, char *argv[])
+{
+    // DSQ_TRACE=<file> records trace spans for the whole run and writes them there.
+    const QString traceFile = qEnvironmentVariable("DSQ_TRACE");
+    if (!traceFile.isEmpty())
+        DsqTrace::setEnabled(true);
+
+    const int exitCode = run(argc, argv);
+
+    if (!traceFile.isEmpty() && !DsqTrace::writeChromeTrace(traceFile))
+        fprintf(stderr, "Failed to write trace to %s\n", qPrintable(traceFile));
+    return exitCode;
+}
+
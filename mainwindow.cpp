@@ -1,14 +1,22 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "ui_openfiretab.h"
 #include "IniSyntaxHighlighter.h" // Fixed case sensitivity
+#include "bulkedit.h"
+#include "configlayers.h"
+#include "dsqlogging.h"
+#include "dsqtrace.h"
 #include "emulatorutils.h"
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QFile>
 #include <QFileInfo>
+#include <QTemporaryFile>
 #include <QTextStream>
 #include <QDebug>
 #include <QFont>
+#include <QFontDatabase>
 #include <QSyntaxHighlighter>
 #include <QRegularExpression>
 #include <QTextCharFormat>
@@ -23,6 +31,22 @@
 #include <QSettings>
 #include <QCoreApplication>
 #include <QSignalBlocker>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QScrollBar>
+#include <QShortcut>
+#include <QHeaderView>
+#include <QTableWidget>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <vector>
+#include "exportcache.h"
+#include "hooklogpane.h"
+#include "iniindex.h"
+#include "linediff.h"
+#include "openfireconfig.h"
+#include "textfile.h"
 
 // Global color definitions.
 QColor customRed(255, 0, 0);      // Red using RGB values
@@ -30,36 +54,46 @@ QColor customGreen(0, 255, 0);      // Green using RGB values
 QColor customBlue(0, 0, 255);       // Blue using RGB values
 QColor customYellow(255, 255, 0);   // Yellow using RGB values
 
-// Define static regex patterns.
-const QRegularExpression MainWindow::recoilRegex(
-    QRegularExpression(R"(^P1_CtmRecoil[ \t]*=[ \t]*cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$))", QRegularExpression::MultilineOption)
-);
-const QRegularExpression MainWindow::damageRegex(
-    QRegularExpression(R"(^P1_Damaged[ \t]*=[ \t]*cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$))", QRegularExpression::MultilineOption)
-);
-const QRegularExpression MainWindow::clipRegex(
-    QRegularExpression(R"(^P1_Clip[ \t]*=[ \t]*cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$))", QRegularExpression::MultilineOption)
-);
-const QRegularExpression MainWindow::ammoRegex(
-    QRegularExpression(R"(^P1_Ammo[ \t]*=[ \t]*(?:cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$)|[ \t]*(?=\r?\n|$)))", QRegularExpression::MultilineOption)
-);
-const QRegularExpression MainWindow::lifeRegex(
-    QRegularExpression(R"(^P1_Life[ \t]*=[ \t]*(?:cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$)|[ \t]*(?=\r?\n|$)))", QRegularExpression::MultilineOption)
-);
-const QRegularExpression MainWindow::creditsRegex(
-    QRegularExpression(R"(^Credits[ \t]*=[ \t]*(?:cmw[ \t]*1[ \t]*(.*?)[ \t]*(?=\r?\n|$)|[ \t]*(?=\r?\n|$)))", QRegularExpression::MultilineOption)
-);
+// Location of the persisted application settings (next to the executable).
+static QString settingsFilePath()
+{
+    return QDir(QCoreApplication::applicationDirPath()).filePath("settings.ini");
+}
 
 //
 // MainWindow Constructor & Destructor
 //
-MainWindow::MainWindow(QWidget *parent) :
+MainWindow::MainWindow(QWidget *parent, const QString &settingsPath) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    settingsPath(settingsPath.isEmpty() ? settingsFilePath() : settingsPath),
+    profiles(this->settingsPath)
 {
+    startupTimer.start();
+    DsqLogging::applySettings(this->settingsPath);
+
     ui->setupUi(this);
+    markStartupPhase("setupUi");
+
+    // Short enough that a power cut loses at most the last edit
+    profileSaveTimer = new QTimer(this);
+    profileSaveTimer->setSingleShot(true);
+    profileSaveTimer->setInterval(profileSaveDelayMs);
+    connect(profileSaveTimer, &QTimer::timeout, this, &MainWindow::saveOutputProfile);
+
+    // Changes by other programs to the loaded ini/bat, coalesced
+    fileWatcher = new QFileSystemWatcher(this);
+    fileChangeTimer = new QTimer(this);
+    fileChangeTimer->setSingleShot(true);
+    fileChangeTimer->setInterval(fileChangeDelayMs);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        pendingFileChanges.insert(path);
+        fileChangeTimer->start();
+    });
+    connect(fileChangeTimer, &QTimer::timeout, this, &MainWindow::reloadChangedFiles);
 
     initializeUI();
+    markStartupPhase("initializeUI");
 
     // Initialize the syntax highlighter for the plain text edit.
     new IniSyntaxHighlighter(ui->plainTextEdit_Generic->document());
@@ -73,15 +107,134 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->demulShooterPathLineEdit->setText(QDir::homePath() + "/DemulShooter");
     #endif
 
-    loadSettings();
+    // loadSettings() selects widgets that kick off more work; it runs after
+    // the first paint so the window shows up first (see completeStartup).
 }
 
 MainWindow::~MainWindow()
 {
-    saveSettings();
+    indexPool.waitForDone();
+    validationPool.waitForDone();
+    // Never overwrite the saved settings with defaults that were never loaded
+    if (startupComplete)
+        saveSettings();
+    // Only a profile the user edited is saved; the widgets may still hold
+    // another game's values
+    if (profileDirty)
+        saveOutputProfile();
+    delete openFire;
     delete ui;
 }
 
+///
+/// Logs how long the startup phase that just finished took, and records it
+/// as a trace span when tracing is on.
+///
+void MainWindow::markStartupPhase(const char *phase)
+{
+    const qint64 nowNs = startupTimer.nsecsElapsed();
+    qCDebug(lcStartup) << "Startup phase" << phase << "took"
+                       << (nowNs - lastStartupPhaseNs) / 1000000.0 << "ms, total"
+                       << nowNs / 1000000.0 << "ms";
+    if (DsqTrace::isEnabled()) {
+        const qint64 traceNowNs = DsqTrace::nowNs();
+        DsqTrace::record(phase, traceNowNs - (nowNs - lastStartupPhaseNs), traceNowNs);
+    }
+    lastStartupPhaseNs = nowNs;
+}
+
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    if (firstPaintSeen)
+        return;
+    firstPaintSeen = true;
+    markStartupPhase("first paint");
+    QTimer::singleShot(0, this, &MainWindow::completeStartup);
+}
+
+void MainWindow::completeStartup()
+{
+    if (startupComplete)
+        return;
+    startupComplete = true;
+
+    loadSettings();
+    markStartupPhase("loadSettings");
+
+    restoreSession();
+    markStartupPhase("restoreSession");
+
+    if (ui->tabWidget_Advanced->currentWidget() == ui->tab_OpenFIRE) {
+        ensureOpenFireTab();
+        markStartupPhase("OpenFIRE tab");
+    }
+
+    // Warm the ini index off the UI thread so the overview opens instantly
+    refreshIniIndex();
+}
+
+///
+/// Brings the ini index up to date on a worker thread (only changed files
+/// are reparsed) and shows the result in the Overview tab.
+///
+void MainWindow::refreshIniIndex()
+{
+    if (indexRefreshRunning)
+        return;
+    indexRefreshRunning = true;
+
+    const QString iniDir = ui->qmamehookerPathLineEdit->text() + "/ini";
+    const QString cachePath = IniIndex::cachePathFor(settingsPath);
+    IniIndex index = iniIndex;
+    indexPool.start([this, index, iniDir, cachePath]() mutable {
+        if (index.directory().isEmpty())
+            index.load(cachePath);
+        if (index.refresh(iniDir) > 0)
+            index.save(cachePath);
+        // The destructor waits for this pool, so this is still alive here
+        QMetaObject::invokeMethod(this, [this, index]() {
+            indexRefreshRunning = false;
+            iniIndex = index;
+            showIniIndex();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::showIniIndex()
+{
+    DSQ_TRACE_SPAN("MainWindow::showIniIndex");
+    const QList<IniIndex::Entry> entries = iniIndex.entries();
+
+    overviewTable->setSortingEnabled(false);
+    overviewTable->setRowCount(entries.size());
+    for (int row = 0; row < entries.size(); ++row) {
+        const IniIndex::Entry &entry = entries[row];
+
+        QStringList colours;
+        for (int player = 0; player < entry.playerCount && player < 4; ++player) {
+            const LedColor &led = entry.ledColors[player];
+            colours << (led.isValid() ? QColor(led.red, led.green, led.blue).name() : QString("-"));
+        }
+        const QString recoil = entry.outputs.value("CtmRecoil");
+        const QString damaged = entry.outputs.value("Damaged");
+
+        const QStringList cells = {
+            entry.fileName,
+            QString::number(entry.playerCount),
+            entry.startCommand,
+            entry.modeFlags.join(' '),
+            entry.outputs.contains("CtmRecoil") ? (recoil.isEmpty() ? "not set" : recoil) : "-",
+            entry.outputs.contains("Damaged") ? (damaged.isEmpty() ? "not set" : damaged) : "-",
+            colours.join(' '),
+        };
+        for (int column = 0; column < cells.size(); ++column)
+            overviewTable->setItem(row, column, new QTableWidgetItem(cells[column]));
+    }
+    overviewTable->setSortingEnabled(true);
+    overviewTable->resizeColumnsToContents();
+}
+
 ///
 /// Initialization helper – sets up UI elements, styles, and connects signals.
 ///
@@ -89,10 +242,56 @@ void MainWindow::initializeUI() {
     setupEmulatorComboBox();
     setupComboBoxStyles();
     setupOtherUIFields();
-    setupColorComboBoxes();
     setupSignalConnections();
     setupDefaultIni();
     
+    // QMamehook output captured during verbose launches
+    hookLog = new HookLogPane(20000, this);
+    ui->tabWidget_Advanced->addTab(hookLog, tr("Hooker Log"));
+
+    // What every game's ini configures, filled from the background index
+    overviewTable = new QTableWidget(0, 7, this);
+    overviewTable->setHorizontalHeaderLabels({"Ini", "Players", "Start", "Modes", "Recoil", "Damaged", "LED colours"});
+    overviewTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    overviewTable->verticalHeader()->setVisible(false);
+    ui->tabWidget_Advanced->addTab(overviewTable, tr("Overview"));
+
+    // Line diff of the ini and bat against the files Export would overwrite
+    exportPreview = new QPlainTextEdit(this);
+    exportPreview->setReadOnly(true);
+    exportPreview->setLineWrapMode(QPlainTextEdit::NoWrap);
+    exportPreview->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    ui->tabWidget_Advanced->addTab(exportPreview, tr("Export Preview"));
+    exportPreviewTimer = new QTimer(this);
+    exportPreviewTimer->setSingleShot(true);
+    exportPreviewTimer->setInterval(exportPreviewDelayMs);
+    connect(exportPreviewTimer, &QTimer::timeout, this, &MainWindow::refreshExportPreview);
+    auto schedulePreview = [this]() {
+        if (ui->tabWidget_Advanced->currentWidget() == exportPreview)
+            exportPreviewTimer->start();
+    };
+    connect(ui->plainTextEdit_Generic, &QPlainTextEdit::textChanged, this, schedulePreview);
+    connect(ui->plainTextEdit_Bat, &QPlainTextEdit::textChanged, this, schedulePreview);
+
+    // The OpenFIRE tab is the bulk of the form; build it when first opened
+    connect(ui->tabWidget_Advanced, &QTabWidget::currentChanged, this, [this]() {
+        if (ui->tabWidget_Advanced->currentWidget() == ui->tab_OpenFIRE)
+            ensureOpenFireTab();
+        else if (ui->tabWidget_Advanced->currentWidget() == overviewTable)
+            refreshIniIndex();
+        else if (ui->tabWidget_Advanced->currentWidget() == exportPreview)
+            refreshExportPreview();
+    });
+
+    // Check the ini's serial commands in the background while it is edited
+    validationPool.setMaxThreadCount(1);
+    validationTimer = new QTimer(this);
+    validationTimer->setSingleShot(true);
+    validationTimer->setInterval(validationDelayMs);
+    connect(validationTimer, &QTimer::timeout, this, &MainWindow::startValidation);
+    connect(ui->plainTextEdit_Generic, &QPlainTextEdit::textChanged, validationTimer, QOverload<>::of(&QTimer::start));
+    connect(ui->plainTextEdit_Generic, &QPlainTextEdit::cursorPositionChanged, this, &MainWindow::showProblemAtCursor);
+
     // Add context menu to the text editor
     ui->plainTextEdit_Generic->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(ui->plainTextEdit_Generic, &QPlainTextEdit::customContextMenuRequested,
@@ -103,7 +302,8 @@ void MainWindow::initializeUI() {
 /// Sets up the emulator combo box with items and the max visible items.
 ///
 void MainWindow::setupEmulatorComboBox() {
-    EmulatorUtils::setupEmulatorComboBox(ui->emulatorComboBox);
+    ui->emulatorComboBox->addItems(EmulatorUtils::emulatorList());
+    ui->emulatorComboBox->setMaxVisibleItems(60);
 }
 
 ///
@@ -127,61 +327,47 @@ void MainWindow::setupComboBoxStyles() {
 void MainWindow::setupOtherUIFields() {
     // Basic fields.
     ui->verboseComboBox->addItems({"Yes", "No"});
+    // Verbose launches log every output QMamehook sends, so only on request
+    ui->verboseComboBox->setCurrentText("No");
     ui->emulatorPathLineEdit->setText("Choose Path the Emulator executable");
     ui->romPathLineEdit->setText("C:/roms");
     ui->qmamehookerPathLineEdit->setText("C:/QMamehook");
     ui->demulShooterPathLineEdit->setText("C:/DemulShooter");
+}
 
+///
+/// Fills the OpenFIRE tab's combo boxes with their fixed items.
+///
+void MainWindow::setupOpenFireFields() {
     // LED color combo boxes – add a placeholder.
-    ui->P1Color->addItem("X");
-    ui->P2Color->addItem("X");
-    ui->P3Color->addItem("X");
-    ui->P4Color->addItem("X");
-
-    // Start command combo box.
-    ui->StartCommands->addItems({
-        "S0 - Start with solenoid enabled",
-        "S1 - Start with rumble enabled",
-        "S2 - Start with the RED LED enabled",
-        "S3 - Start with the GREEN LED enabled",
-        "S4 - Start with the BLUE LED enabled",
-        "S6 - Start with everything enabled"
-    });
-    ui->StartCommands->setCurrentIndex(5);
-
-    // Other combo boxes.
-    ui->DeviceOutputMode->addItems({
-        "------", "M0x0 - Mouse & Keyboard", "M0x1 - Gamepad, w/ Camera mapped to Right Stick",
-        "M0x1L - Maps Camera to Left Stick instead (OpenFIRE exclusive)", "M0x2 - 'Hybrid'"
-    });
-    ui->OffscreenFiringMode->addItems({
-        "------", "M1x0 - Disabled (not used in OpenFIRE)", "M1x1 - Fire in bottom-left corner (not used in OpenFIRE)",
-        "M1x2 - Offscreen Button Mode enabled (i.e. offscreen trigger pulls generates a Right Click instead of a Left Click)",
-        "M1x3 - Normal shot (always on when Offscreen Button Mode isn't set in OpenFIRE)"
-    });
-    ui->OffscreenFiringMode->setItemData(1, QVariant(0), Qt::UserRole - 1);
-    ui->OffscreenFiringMode->setItemData(2, QVariant(0), Qt::UserRole - 1);
-
-    ui->PedalMapping->addItems({
-        "------", "M2x0 - Separate Button (as mapped)", "M2x1 - As Right Mouse", "M2x2 - As Middle Mouse (OpenFIRE exclusive)"
-    });
-
-
-    ui->AspectRatioCorrection->addItems({"------", "M3x0 - Fullscreen", "M3x1 - 4:3 Correction"});
-    ui->RumbleOnlyMode->addItems({"------", "M6x0 - Disabled (Solenoid allowed)", "M6x1 - Enabled (Solenoid disabled, Rumble enabled)"});
-    ui->AutoFireMode->addItems({"------", "M8x0 - Disabled (sustained fire is kept enabled in OpenFIRE)", "M8x1 - Auto fire on (enables Burst Fire in OpenFIRE)", "M8x2 - Auto fire always on rapid fire"});
-    ui->DisplayMode->addItems({"------", "MDx1 - Life Only", "MDx2 - Ammo Only", "MDx3 - Life & Ammo Splitscreen", "MDx3B - Life Bar (Life Glyphs otherwise)"});
-    ui->Recoil->addItems({"------", "Solenoid Single Pulse (recommended)", "Solenoid Switching", "Rumble Single Pulse (recommended for rumble)", "Rumble Switching", "Custom"});
-    ui->Damaged->addItems({"------", "Rumble Single Pulse (recommended)", "Rumble Switching", "Custom"});
-    ui->Clip->addItems({"------", "Red/Off", "Red/White", "White/Off", "Custom"});
-    ui->Ammo->addItems({"------", "OLED On", "Custom"});
-    ui->Life->addItems({"------", "OLED On", "Custom"});
-    ui->Credits->addItems({"------", "OLED On (coming soon)", "Custom"});
+    openFire->P1Color->addItem("X");
+    openFire->P2Color->addItem("X");
+    openFire->P3Color->addItem("X");
+    openFire->P4Color->addItem("X");
+
+    // Start command and mode combo boxes, from the flag table.
+    for (const auto &flagCombo : flagCombos()) {
+        const OpenFireFlags::Family &family = *flagCombo.first;
+        QComboBox *combo = flagCombo.second;
+        combo->addItems(OpenFireFlags::itemTexts(family));
+        for (const OpenFireFlags::Option &option : family.options) {
+            if (!option.selectable)
+                combo->setItemData(OpenFireFlags::itemIndex(family, option.code), QVariant(0), Qt::UserRole - 1);
+        }
+        combo->setCurrentIndex(OpenFireFlags::itemIndex(family, QString()));
+    }
 
-    ui->P1Color->setCurrentIndex(1);
-    ui->P2Color->setCurrentIndex(2);
-    ui->P3Color->setCurrentIndex(3);
-    ui->P4Color->setCurrentIndex(4);
+    openFire->Recoil->addItems({"------", "Solenoid Single Pulse (recommended)", "Solenoid Switching", "Rumble Single Pulse (recommended for rumble)", "Rumble Switching", "Custom"});
+    openFire->Damaged->addItems({"------", "Rumble Single Pulse (recommended)", "Rumble Switching", "Custom"});
+    openFire->Clip->addItems({"------", "Red/Off", "Red/White", "White/Off", "Custom"});
+    openFire->Ammo->addItems({"------", "OLED On", "Custom"});
+    openFire->Life->addItems({"------", "OLED On", "Custom"});
+    openFire->Credits->addItems({"------", "OLED On (coming soon)", "Custom"});
+
+    openFire->P1Color->setCurrentIndex(1);
+    openFire->P2Color->setCurrentIndex(2);
+    openFire->P3Color->setCurrentIndex(3);
+    openFire->P4Color->setCurrentIndex(4);
 }
 
 ///
@@ -195,14 +381,15 @@ void MainWindow::setupColorComboBoxes() {
     };
 
     for (const QColor &color : colors) {
+        ledColorIndex.insert(color.rgb(), openFire->P1Color->count());
         QPixmap pixmap(20, 20);
         pixmap.fill(color);
         QIcon icon(pixmap);
         // Add icon with a blank text and store the color as userData.
-        ui->P1Color->addItem(icon, " ", color);
-        ui->P2Color->addItem(icon, " ", color);
-        ui->P3Color->addItem(icon, " ", color);
-        ui->P4Color->addItem(icon, " ", color);
+        openFire->P1Color->addItem(icon, " ", color);
+        openFire->P2Color->addItem(icon, " ", color);
+        openFire->P3Color->addItem(icon, " ", color);
+        openFire->P4Color->addItem(icon, " ", color);
     }
 }
 
@@ -217,6 +404,7 @@ void MainWindow::setupSignalConnections() {
     // Export and Launch button signals.
     connect(ui->exportButton, &QPushButton::clicked, this, [this]() { exportFiles(); });
     connect(ui->LaunchButton, &QPushButton::clicked, this, &MainWindow::launchGame);
+    connect(ui->applyAllButton, &QPushButton::clicked, this, &MainWindow::applyToAllGames);
 
     // Browse button signals.
     connect(ui->browseEmulatorButton, &QPushButton::clicked, this, &MainWindow::browseEmulatorPath);
@@ -227,393 +415,382 @@ void MainWindow::setupSignalConnections() {
     // DemulShooter extra arguments
     connect(ui->demulShooterArgsLineEdit, &QLineEdit::textChanged, this, &MainWindow::updateBatCommandLine);
 
+    // Connect the refresh INI button using findChild to avoid linter errors
+    QPushButton* refreshButton = findChild<QPushButton*>("refreshIniButton");
+    if (refreshButton) {
+        connect(refreshButton, &QPushButton::clicked, this, &MainWindow::refreshIni);
+    } else {
+        qWarning() << "Could not find refreshIniButton in the UI";
+    }
+
+    // Ctrl+Shift+T starts recording trace spans, and saves them when pressed again.
+    connect(new QShortcut(QKeySequence("Ctrl+Shift+T"), this), &QShortcut::activated,
+            this, &MainWindow::toggleTrace);
+
+    // Undo/redo setting changes. The ini, bat and output text editors keep
+    // these keys for their own typing while they have focus.
+    connect(new QShortcut(QKeySequence::Undo, this), &QShortcut::activated,
+            this, &MainWindow::undoIniChange);
+    connect(new QShortcut(QKeySequence::Redo, this), &QShortcut::activated,
+            this, &MainWindow::redoIniChange);
+}
+
+///
+/// Connects the OpenFIRE tab's widgets; runs once, when the tab is built.
+///
+void MainWindow::setupOpenFireConnections() {
+    // Any output choice the user makes schedules a save of this game's profile
+    auto markProfileEdited = [this]() {
+        if (isLoadingIni)
+            return;
+        profileDirty = true;
+        profileSaveTimer->start();
+    };
+    for (const OutputField &field : outputFields()) {
+        connect(field.combo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, markProfileEdited);
+        if (field.text)
+            connect(field.text, &QTextEdit::textChanged, this, markProfileEdited);
+    }
+
     // INI update signals for various combo boxes.
-    connect(ui->StartCommands, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->DeviceOutputMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->OffscreenFiringMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->PedalMapping, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->AspectRatioCorrection, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->RumbleOnlyMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->AutoFireMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->DisplayMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
-    connect(ui->P1Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::updateIniText);
-    connect(ui->P2Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::updateIniText);
-    connect(ui->P3Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::updateIniText);
-    connect(ui->P4Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MainWindow::updateIniText);
+    connect(openFire->StartCommands, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->DeviceOutputMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->OffscreenFiringMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->PedalMapping, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->AspectRatioCorrection, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->RumbleOnlyMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->AutoFireMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
+    connect(openFire->DisplayMode, &QComboBox::currentTextChanged, this, &MainWindow::updateIniText);
 
     // Parameter combo box and text field connections.
-    connect(ui->Recoil, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Recoil, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Recoil_Text->setPlainText("");
+            openFire->Recoil_Text->setPlainText("");
             // Clear all Recoil lines
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("P1_CtmRecoil") || 
-                    lines[i].startsWith("P2_CtmRecoil") || 
-                    lines[i].startsWith("P3_CtmRecoil") || 
-                    lines[i].startsWith("P4_CtmRecoil")) {
-                    QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                    lines[i] = QString("%1_CtmRecoil =").arg(prefix);
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "Solenoid Single Pulse (recommended)") ui->Recoil_Text->setPlainText("F0x2x1");
-        else if (text == "Solenoid Switching") ui->Recoil_Text->setPlainText("F0x%s%");
-        else if (text == "Rumble Single Pulse (recommended for rumble)") ui->Recoil_Text->setPlainText("F1x2x1");
-        else if (text == "Rumble Switching") ui->Recoil_Text->setPlainText("F1x%s%");
+            setOutputForAllPlayers("CtmRecoil", QString());
+        } else if (text == "Solenoid Single Pulse (recommended)") openFire->Recoil_Text->setPlainText("F0x2x1");
+        else if (text == "Solenoid Switching") openFire->Recoil_Text->setPlainText("F0x%s%");
+        else if (text == "Rumble Single Pulse (recommended for rumble)") openFire->Recoil_Text->setPlainText("F1x2x1");
+        else if (text == "Rumble Switching") openFire->Recoil_Text->setPlainText("F1x%s%");
     });
 
-    connect(ui->Recoil_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Recoil_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("P1_CtmRecoil") || 
-                lines[i].startsWith("P2_CtmRecoil") || 
-                lines[i].startsWith("P3_CtmRecoil") || 
-                lines[i].startsWith("P4_CtmRecoil")) {
-                QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                int playerNum = prefix.mid(1).toInt(); // Get the number from P1, P2, etc.
-                if (value.isEmpty()) {
-                    lines[i] = QString("%1_CtmRecoil =").arg(prefix);
-                } else {
-                    lines[i] = QString("%1_CtmRecoil = cmw %2 %3").arg(prefix).arg(playerNum).arg(value);
-                }
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Recoil_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("CtmRecoil", openFire->Recoil_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Damaged, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Damaged, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Damaged_Text->setPlainText("");
+            openFire->Damaged_Text->setPlainText("");
             // Clear all Damaged lines
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("P1_Damaged") || 
-                    lines[i].startsWith("P2_Damaged") || 
-                    lines[i].startsWith("P3_Damaged") || 
-                    lines[i].startsWith("P4_Damaged")) {
-                    QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                    lines[i] = QString("%1_Damaged =").arg(prefix);
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "Rumble Single Pulse (recommended)") ui->Damaged_Text->setPlainText("F1x2x1");
-        else if (text == "Rumble Switching") ui->Damaged_Text->setPlainText("F1x%s%");
+            setOutputForAllPlayers("Damaged", QString());
+        } else if (text == "Rumble Single Pulse (recommended)") openFire->Damaged_Text->setPlainText("F1x2x1");
+        else if (text == "Rumble Switching") openFire->Damaged_Text->setPlainText("F1x%s%");
     });
 
-    connect(ui->Damaged_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Damaged_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("P1_Damaged") || 
-                lines[i].startsWith("P2_Damaged") || 
-                lines[i].startsWith("P3_Damaged") || 
-                lines[i].startsWith("P4_Damaged")) {
-                QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                int playerNum = prefix.mid(1).toInt(); // Get the number from P1, P2, etc.
-                if (value.isEmpty()) {
-                    lines[i] = QString("%1_Damaged =").arg(prefix);
-                } else {
-                    lines[i] = QString("%1_Damaged = cmw %2 %3").arg(prefix).arg(playerNum).arg(value);
-                }
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Damaged_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("Damaged", openFire->Damaged_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Clip, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Clip, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Clip_Text->setPlainText("");
+            openFire->Clip_Text->setPlainText("");
             // Clear all Clip lines
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("P1_Clip") || 
-                    lines[i].startsWith("P2_Clip") || 
-                    lines[i].startsWith("P3_Clip") || 
-                    lines[i].startsWith("P4_Clip")) {
-                    QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                    lines[i] = QString("%1_Clip =").arg(prefix);
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "Red/Off") ui->Clip_Text->setPlainText("F2x1x255xF3x1x0xF4x1x0");
-        else if (text == "Red/White") ui->Clip_Text->setPlainText("F2x1x255xF3x1x255xF4x1x255");
-        else if (text == "White/Off") ui->Clip_Text->setPlainText("F2x1x255xF3x1x255xF4x1x255");
+            setOutputForAllPlayers("Clip", QString());
+        } else if (text == "Red/Off") openFire->Clip_Text->setPlainText("F2x1x255xF3x1x0xF4x1x0");
+        else if (text == "Red/White") openFire->Clip_Text->setPlainText("F2x1x255xF3x1x255xF4x1x255");
+        else if (text == "White/Off") openFire->Clip_Text->setPlainText("F2x1x255xF3x1x255xF4x1x255");
     });
 
-    connect(ui->Clip_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Clip_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("P1_Clip") || 
-                lines[i].startsWith("P2_Clip") || 
-                lines[i].startsWith("P3_Clip") || 
-                lines[i].startsWith("P4_Clip")) {
-                QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                int playerNum = prefix.mid(1).toInt(); // Get the number from P1, P2, etc.
-                if (value.isEmpty()) {
-                    lines[i] = QString("%1_Clip =").arg(prefix);
-                } else {
-                    lines[i] = QString("%1_Clip = cmw %2 %3").arg(prefix).arg(playerNum).arg(value);
-                }
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Clip_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("Clip", openFire->Clip_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Ammo, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Ammo, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Ammo_Text->setPlainText("");
+            openFire->Ammo_Text->setPlainText("");
             // Clear all Ammo lines
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("P1_Ammo") || 
-                    lines[i].startsWith("P2_Ammo") || 
-                    lines[i].startsWith("P3_Ammo") || 
-                    lines[i].startsWith("P4_Ammo")) {
-                    QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                    lines[i] = QString("%1_Ammo =").arg(prefix);
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "OLED On") ui->Ammo_Text->setPlainText("FDAx%s%");
+            setOutputForAllPlayers("Ammo", QString());
+        } else if (text == "OLED On") openFire->Ammo_Text->setPlainText("FDAx%s%");
     });
 
-    connect(ui->Ammo_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Ammo_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("P1_Ammo") || 
-                lines[i].startsWith("P2_Ammo") || 
-                lines[i].startsWith("P3_Ammo") || 
-                lines[i].startsWith("P4_Ammo")) {
-                QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                int playerNum = prefix.mid(1).toInt(); // Get the number from P1, P2, etc.
-                if (value.isEmpty()) {
-                    lines[i] = QString("%1_Ammo =").arg(prefix);
-                } else {
-                    lines[i] = QString("%1_Ammo = cmw %2 %3").arg(prefix).arg(playerNum).arg(value);
-                }
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Ammo_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("Ammo", openFire->Ammo_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Life, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Life, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Life_Text->setPlainText("");
+            openFire->Life_Text->setPlainText("");
             // Clear all Life lines
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("P1_Life") || 
-                    lines[i].startsWith("P2_Life") || 
-                    lines[i].startsWith("P3_Life") || 
-                    lines[i].startsWith("P4_Life")) {
-                    QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                    lines[i] = QString("%1_Life =").arg(prefix);
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "OLED On") ui->Life_Text->setPlainText("FDLx%s%");
+            setOutputForAllPlayers("Life", QString());
+        } else if (text == "OLED On") openFire->Life_Text->setPlainText("FDLx%s%");
     });
 
-    connect(ui->Life_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Life_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("P1_Life") || 
-                lines[i].startsWith("P2_Life") || 
-                lines[i].startsWith("P3_Life") || 
-                lines[i].startsWith("P4_Life")) {
-                QString prefix = lines[i].split("_")[0]; // Get P1, P2, etc.
-                int playerNum = prefix.mid(1).toInt(); // Get the number from P1, P2, etc.
-                if (value.isEmpty()) {
-                    lines[i] = QString("%1_Life =").arg(prefix);
-                } else {
-                    lines[i] = QString("%1_Life = cmw %2 %3").arg(prefix).arg(playerNum).arg(value);
-                }
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Life_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("Life", openFire->Life_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Credits, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+    connect(openFire->Credits, &QComboBox::currentTextChanged, this, [this](const QString &text) {
         if (text == "------") {
-            ui->Credits_Text->setPlainText("");
+            openFire->Credits_Text->setPlainText("");
             // Clear Credits line
-            QStringList lines = originalIniContent.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                if (lines[i].startsWith("Credits")) {
-                    lines[i] = "Credits =";
-                    break;
-                }
-            }
-            originalIniContent = lines.join('\n');
-            ui->plainTextEdit_Generic->setPlainText(originalIniContent);
-        } else if (text == "OLED On (coming soon)") ui->Credits_Text->setPlainText("cmw 1 F2x1x255xF3x1x255xF4x1x255");
+            setOutputForAllPlayers("Credits", QString());
+        } else if (text == "OLED On (coming soon)") openFire->Credits_Text->setPlainText("cmw 1 F2x1x255xF3x1x255xF4x1x255");
     });
 
-    connect(ui->Credits_Text, &QTextEdit::textChanged, this, [this]() {
-        QString value = ui->Credits_Text->toPlainText().trimmed();
-        QStringList lines = originalIniContent.split('\n');
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith("Credits")) {
-                if (value.isEmpty()) {
-                    lines[i] = "Credits =";
-                } else {
-                    lines[i] = QString("Credits = cmw 1 %1").arg(value);
-                }
-                break;
-            }
-        }
-        originalIniContent = lines.join('\n');
-        ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    connect(openFire->Credits_Text, &QTextEdit::textChanged, this, [this]() {
+        setOutputForAllPlayers("Credits", openFire->Credits_Text->toPlainText().trimmed());
     });
 
-    connect(ui->Custom1, &QComboBox::currentTextChanged, this, [this](const QString &text) {
-        ui->Custom1_Text->setPlainText(text == "------" ? "" : "XX");
+    connect(openFire->Custom1, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+        openFire->Custom1_Text->setPlainText(text == "------" ? "" : "XX");
     });
-    connect(ui->Custom2, &QComboBox::currentTextChanged, this, [this](const QString &text) {
-        ui->Custom2_Text->setPlainText(text == "------" ? "" : "XX");
+    connect(openFire->Custom2, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+        openFire->Custom2_Text->setPlainText(text == "------" ? "" : "XX");
     });
-    connect(ui->Custom3, &QComboBox::currentTextChanged, this, [this](const QString &text) {
-        ui->Custom3_Text->setPlainText(text == "------" ? "" : "XX");
+    connect(openFire->Custom3, &QComboBox::currentTextChanged, this, [this](const QString &text) {
+        openFire->Custom3_Text->setPlainText(text == "------" ? "" : "XX");
     });
 
     // TextEdit changes updating combo boxes and INI text.
-    connect(ui->Recoil_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Recoil_Text->toPlainText().trimmed();
-        if (text.isEmpty()) ui->Recoil->setCurrentText("------");
-        else if (text == "F0x2x1") ui->Recoil->setCurrentText("Solenoid Single Pulse (recommended)");
-        else if (text == "F0x%s%") ui->Recoil->setCurrentText("Solenoid Switching");
-        else if (text == "F1x2x1") ui->Recoil->setCurrentText("Rumble Single Pulse (recommended for rumble)");
-        else if (text == "F1x%s%") ui->Recoil->setCurrentText("Rumble Switching");
-        else ui->Recoil->setCurrentText("Custom");
+    connect(openFire->Recoil_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Recoil_Text->toPlainText().trimmed();
+        if (text.isEmpty()) openFire->Recoil->setCurrentText("------");
+        else if (text == "F0x2x1") openFire->Recoil->setCurrentText("Solenoid Single Pulse (recommended)");
+        else if (text == "F0x%s%") openFire->Recoil->setCurrentText("Solenoid Switching");
+        else if (text == "F1x2x1") openFire->Recoil->setCurrentText("Rumble Single Pulse (recommended for rumble)");
+        else if (text == "F1x%s%") openFire->Recoil->setCurrentText("Rumble Switching");
+        else openFire->Recoil->setCurrentText("Custom");
         updateIniText();
     });
-    connect(ui->Damaged_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Damaged_Text->toPlainText().trimmed();
-        if (text == "F1x2x1") ui->Damaged->setCurrentText("Rumble Single Pulse (recommended)");
-        else if (text == "F1x%s%") ui->Damaged->setCurrentText("Rumble Switching");
-        else if (text.isEmpty()) ui->Damaged->setCurrentText("------");
-        else ui->Damaged->setCurrentText("Custom");
+    connect(openFire->Damaged_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Damaged_Text->toPlainText().trimmed();
+        if (text == "F1x2x1") openFire->Damaged->setCurrentText("Rumble Single Pulse (recommended)");
+        else if (text == "F1x%s%") openFire->Damaged->setCurrentText("Rumble Switching");
+        else if (text.isEmpty()) openFire->Damaged->setCurrentText("------");
+        else openFire->Damaged->setCurrentText("Custom");
         updateIniText();
     });
-    connect(ui->Clip_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Clip_Text->toPlainText().trimmed();
-        if (text == "XX" && ui->Clip->currentText() == "------") ui->Clip->setCurrentText("Red/Off");
-        else if (text.isEmpty()) ui->Clip->setCurrentText("------");
-        else ui->Clip->setCurrentText("Custom");
+    connect(openFire->Clip_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Clip_Text->toPlainText().trimmed();
+        if (text == "XX" && openFire->Clip->currentText() == "------") openFire->Clip->setCurrentText("Red/Off");
+        else if (text.isEmpty()) openFire->Clip->setCurrentText("------");
+        else openFire->Clip->setCurrentText("Custom");
         updateIniText();
     });
-    connect(ui->Ammo_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Ammo_Text->toPlainText().trimmed();
-        if (text == "FDAx%s%") ui->Ammo->setCurrentText("OLED On");
-        else if (text.isEmpty()) ui->Ammo->setCurrentText("------");
-        else ui->Ammo->setCurrentText("Custom");
+    connect(openFire->Ammo_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Ammo_Text->toPlainText().trimmed();
+        if (text == "FDAx%s%") openFire->Ammo->setCurrentText("OLED On");
+        else if (text.isEmpty()) openFire->Ammo->setCurrentText("------");
+        else openFire->Ammo->setCurrentText("Custom");
         updateIniText();
     });
-    connect(ui->Life_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Life_Text->toPlainText().trimmed();
-        if (text == "FDLx%s%") ui->Life->setCurrentText("OLED On");
-        else if (text.isEmpty()) ui->Life->setCurrentText("------");
-        else ui->Life->setCurrentText("Custom");
+    connect(openFire->Life_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Life_Text->toPlainText().trimmed();
+        if (text == "FDLx%s%") openFire->Life->setCurrentText("OLED On");
+        else if (text.isEmpty()) openFire->Life->setCurrentText("------");
+        else openFire->Life->setCurrentText("Custom");
         updateIniText();
     });
-    connect(ui->Credits_Text, &QTextEdit::textChanged, this, [this]() {
-        QString text = ui->Credits_Text->toPlainText().trimmed();
-        if (text == "XX") ui->Credits->setCurrentText("OLED On (coming soon)");
-        else if (text.isEmpty()) ui->Credits->setCurrentText("------");
-        else ui->Credits->setCurrentText("Custom");
+    connect(openFire->Credits_Text, &QTextEdit::textChanged, this, [this]() {
+        QString text = openFire->Credits_Text->toPlainText().trimmed();
+        if (text == "XX") openFire->Credits->setCurrentText("OLED On (coming soon)");
+        else if (text.isEmpty()) openFire->Credits->setCurrentText("------");
+        else openFire->Credits->setCurrentText("Custom");
         updateIniText();
     });
 
-    // Connect the refresh INI button using findChild to avoid linter errors
-    QPushButton* refreshButton = findChild<QPushButton*>("refreshIniButton");
-    if (refreshButton) {
-        connect(refreshButton, &QPushButton::clicked, this, &MainWindow::refreshIni);
-    } else {
-        qWarning() << "Could not find refreshIniButton in the UI";
-    }
-    
     // Connect color dropdowns to update LmpStart values
-    connect(ui->P1Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
-        updateLmpStartValue(1, ui->P1Color->itemData(index).value<QColor>());
+    connect(openFire->P1Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        updateLmpStartValue(1, openFire->P1Color->itemData(index).value<QColor>());
     });
-    connect(ui->P2Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
-        updateLmpStartValue(2, ui->P2Color->itemData(index).value<QColor>());
+    connect(openFire->P2Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        updateLmpStartValue(2, openFire->P2Color->itemData(index).value<QColor>());
     });
-    connect(ui->P3Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
-        updateLmpStartValue(3, ui->P3Color->itemData(index).value<QColor>());
+    connect(openFire->P3Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        updateLmpStartValue(3, openFire->P3Color->itemData(index).value<QColor>());
     });
-    connect(ui->P4Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
-        updateLmpStartValue(4, ui->P4Color->itemData(index).value<QColor>());
+    connect(openFire->P4Color, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        updateLmpStartValue(4, openFire->P4Color->itemData(index).value<QColor>());
     });
 }
 
-bool MainWindow::safeReplaceLine(QStringList &lines, const QString &key, const QString &newLine) {
-    for (int i = 0; i < lines.size(); ++i) {
-        if (lines[i].startsWith(key)) {
-            lines[i] = newLine;
-            return true;
+///
+/// Replaces the ini editor contents; every full-document rewrite goes through here.
+/// Also records the change in iniHistory, unless it is an undo/redo being applied.
+/// Only the block of lines that differs is replaced, so the cursor, scroll
+/// position and the editor's own undo stack survive a setting change.
+///
+void MainWindow::setIniEditorText(const QString &text) {
+    if (!applyingHistory)
+        iniHistory.record(text);
+
+    QPlainTextEdit *editor = ui->plainTextEdit_Generic;
+    const QString current = editor->toPlainText();
+    if (current == text)
+        return;
+    if (current.isEmpty() || text.isEmpty()) {
+        ++counters.setPlainText;
+        editor->setPlainText(text);
+        return;
+    }
+
+    // Blocks of the document match the '\n'-separated lines one to one
+    const IniHistory::Patch patch = IniHistory::diff(current.split('\n'), text.split('\n'));
+    QTextDocument *document = editor->document();
+    const int blockCount = document->blockCount();
+    const QString inserted = patch.insertedLines.join('\n');
+    QTextCursor cursor(document);
+
+    if (patch.removedLines > 0) {
+        const int lastRemoved = patch.firstLine + patch.removedLines - 1;
+        if (!patch.insertedLines.isEmpty()) {
+            // Replace the text of the changed lines, keeping their line breaks
+            cursor.setPosition(document->findBlockByNumber(patch.firstLine).position());
+            const QTextBlock last = document->findBlockByNumber(lastRemoved);
+            cursor.setPosition(last.position() + last.length() - 1, QTextCursor::KeepAnchor);
+        } else if (lastRemoved + 1 < blockCount) {
+            // Remove whole lines together with the line break after them
+            cursor.setPosition(document->findBlockByNumber(patch.firstLine).position());
+            cursor.setPosition(document->findBlockByNumber(lastRemoved + 1).position(), QTextCursor::KeepAnchor);
+        } else {
+            // Trailing lines go with the line break before them
+            const QTextBlock before = document->findBlockByNumber(patch.firstLine - 1);
+            cursor.setPosition(before.position() + before.length() - 1);
+            cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
         }
+        cursor.insertText(inserted);
+    } else if (patch.firstLine < blockCount) {
+        cursor.setPosition(document->findBlockByNumber(patch.firstLine).position());
+        cursor.insertText(inserted + '\n');
+    } else {
+        cursor.movePosition(QTextCursor::End);
+        cursor.insertText('\n' + inserted);
     }
-    return false;
+}
+
+///
+/// Undoes the last OpenFIRE setting change and puts the tab back in step with it.
+///
+void MainWindow::undoIniChange()
+{
+    if (!hasLoadedIni || !iniHistory.undo())
+        return;
+    applyHistoryText();
+}
+
+void MainWindow::redoIniChange()
+{
+    if (!hasLoadedIni || !iniHistory.redo())
+        return;
+    applyHistoryText();
+}
+
+void MainWindow::applyHistoryText()
+{
+    DSQ_TRACE_SPAN("MainWindow::applyHistoryText");
+    applyingHistory = true;
+    originalIniContent = iniHistory.text();
+    setIniEditorText(originalIniContent);
+    if (openFire) {
+        applyOpenFireSettings(originalIniContent);
+        // The output combos changed with their signals blocked
+        profileDirty = true;
+        profileSaveTimer->start();
+    }
+    applyingHistory = false;
+}
+
+void MainWindow::setOutputForAllPlayers(const QString &key, const QString &value) {
+    originalIniContent = OpenFireConfig::setOutputForAllPlayers(originalIniContent, key, value);
+    setIniEditorText(originalIniContent);
 }
 
 void MainWindow::updateLmpStartValue(int player, const QColor &color) {
     if (!hasLoadedIni || originalIniContent.isEmpty()) return;
-    
-    QStringList lines = originalIniContent.split('\n');
-    QString key = QString("P%1_LmpStart").arg(player);
-    
-    // Check if "X" is selected (index 0)
-    if (player == 1 && ui->P1Color->currentIndex() == 0 ||
-        player == 2 && ui->P2Color->currentIndex() == 0 ||
-        player == 3 && ui->P3Color->currentIndex() == 0 ||
-        player == 4 && ui->P4Color->currentIndex() == 0) {
-        // Clear only this player's LmpStart value
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith(key)) {
-                lines[i] = QString("%1 =").arg(key);
-                break;
-            }
-        }
-    } else {
-        // Format: cmw <player> F2x1x<red>xF3x1x<green>xF4x1x<blue> | cmw <player> F2x1x0xF3x1x0xF4x1x0
-        QString value = QString("cmw %1 F2x1x%2xF3x1x%3xF4x1x%4 | cmw %1 F2x1x0xF3x1x0xF4x1x0")
-            .arg(player)
-            .arg(color.red())
-            .arg(color.green())
-            .arg(color.blue());
-            
-        bool found = false;
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].startsWith(key)) {
-                lines[i] = QString("%1 = %2").arg(key).arg(value);
-                found = true;
-                break;
-            }
-        }
-        
-        if (!found) {
-            lines.append(QString("%1 = %2").arg(key).arg(value));
+
+    // "X" (index 0) clears this player's LmpStart value
+    const QComboBox *playerColors[] = {openFire->P1Color, openFire->P2Color, openFire->P3Color, openFire->P4Color};
+    LedColor led;
+    if (player >= 1 && player <= 4 && playerColors[player - 1]->currentIndex() != 0) {
+        led.red = color.red();
+        led.green = color.green();
+        led.blue = color.blue();
+    }
+
+    // Usually the line is already there and only it changes
+    if (replaceLmpStartLine(player, OpenFireConfig::lmpStartLine(player, led)))
+        return;
+
+    originalIniContent = OpenFireConfig::setLmpStart(originalIniContent, player, led);
+    setIniEditorText(originalIniContent);
+}
+
+// True when text has a whole line starting with key at [offset, offset + length).
+static bool isLineAt(const QString &text, qsizetype offset, qsizetype length, const QString &key)
+{
+    if (offset < 0 || offset + length > text.size() || (offset > 0 && text.at(offset - 1) != '\n'))
+        return false;
+    if (offset + length < text.size() && text.at(offset + length) != '\n')
+        return false;
+    const QStringView line = QStringView(text).mid(offset, length);
+    return line.startsWith(key) && !line.contains(QLatin1Char('\n'));
+}
+
+static bool findLineStartingWith(const QString &text, const QString &key, qsizetype &offset, qsizetype &length)
+{
+    for (qsizetype start = 0; start <= text.size(); ) {
+        qsizetype end = text.indexOf('\n', start);
+        if (end < 0)
+            end = text.size();
+        if (QStringView(text).mid(start, end - start).startsWith(key)) {
+            offset = start;
+            length = end - start;
+            return true;
         }
+        start = end + 1;
     }
-    
-    originalIniContent = lines.join('\n');
-    ui->plainTextEdit_Generic->setPlainText(originalIniContent);
+    return false;
+}
+
+///
+/// Rewrites player's LmpStart line in originalIniContent and as a single block
+/// in the editor. False, with nothing changed, when either text has no such line.
+///
+bool MainWindow::replaceLmpStartLine(int player, const QString &line)
+{
+    DSQ_TRACE_SPAN("MainWindow::replaceLmpStartLine");
+    const QString key = QString("P%1_LmpStart").arg(player);
+    LmpStartLine &entry = lmpStartLines[player - 1];
+
+    if (!isLineAt(originalIniContent, entry.offset, entry.length, key)
+        && !findLineStartingWith(originalIniContent, key, entry.offset, entry.length))
+        return false;
+
+    QTextDocument *document = ui->plainTextEdit_Generic->document();
+    QTextBlock block = document->findBlockByNumber(entry.block);
+    if (!block.isValid() || !block.text().startsWith(key)) {
+        for (block = document->begin(); block.isValid() && !block.text().startsWith(key); block = block.next()) {}
+        if (!block.isValid())
+            return false;
+        entry.block = block.blockNumber();
+    }
+
+    // The other players' lines after this one move by the change in length
+    const qsizetype delta = line.size() - entry.length;
+    for (LmpStartLine &other : lmpStartLines) {
+        if (&other != &entry && other.offset > entry.offset)
+            other.offset += delta;
+    }
+    originalIniContent.replace(entry.offset, entry.length, line);
+    entry.length = line.size();
+
+    const QString before = block.text();
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    cursor.insertText(line);
+    if (!applyingHistory && !iniHistory.recordLine(entry.block, before, line))
+        iniHistory.record(ui->plainTextEdit_Generic->toPlainText());
+    return true;
 }
 
 ///
@@ -627,99 +804,73 @@ void MainWindow::setupDefaultIni() {
     // Reset the loaded flag
     originalIniContent = "";
     hasLoadedIni = false;
-    
+
+    if (openFire)
+        resetOpenFireFields();
+}
+
+///
+/// Puts the OpenFIRE tab back to its state before any INI is loaded.
+///
+void MainWindow::resetOpenFireFields() {
     // By default, only enable Player 1 controls
     // Other players will be enabled when we detect them in an INI file
-    ui->P1Color->setEnabled(true);
-    ui->P2Color->setEnabled(false);
-    ui->P3Color->setEnabled(false);
-    ui->P4Color->setEnabled(false);
+    openFire->P1Color->setEnabled(true);
+    openFire->P2Color->setEnabled(false);
+    openFire->P3Color->setEnabled(false);
+    openFire->P4Color->setEnabled(false);
     
     // Hide custom fields by default - they will be shown if detected in INI
-    ui->lineEdit->setVisible(false);
-    ui->Custom1->setVisible(false);
-    ui->Custom1_Text->setVisible(false);
+    openFire->lineEdit->setVisible(false);
+    openFire->Custom1->setVisible(false);
+    openFire->Custom1_Text->setVisible(false);
     
-    ui->lineEdit_2->setVisible(false);
-    ui->Custom2->setVisible(false);
-    ui->Custom2_Text->setVisible(false);
+    openFire->lineEdit_2->setVisible(false);
+    openFire->Custom2->setVisible(false);
+    openFire->Custom2_Text->setVisible(false);
     
-    ui->lineEdit_3->setVisible(false);
-    ui->Custom3->setVisible(false);
-    ui->Custom3_Text->setVisible(false);
+    openFire->lineEdit_3->setVisible(false);
+    openFire->Custom3->setVisible(false);
+    openFire->Custom3_Text->setVisible(false);
     
     // Reset custom field labels
-    ui->lineEdit->setText("Custom 1.");
-    ui->lineEdit_2->setText("Custom 2.");
-    ui->lineEdit_3->setText("Custom 3.");
+    openFire->lineEdit->setText("Custom 1.");
+    openFire->lineEdit_2->setText("Custom 2.");
+    openFire->lineEdit_3->setText("Custom 3.");
     
     // Make sure all standard controls are visible by default
     // They will be hidden if not found in the INI file
-    ui->Recoil->setVisible(true);
-    ui->Recoil_Text->setVisible(true);
-    ui->Recoil_Label->setVisible(true);
+    openFire->Recoil->setVisible(true);
+    openFire->Recoil_Text->setVisible(true);
+    openFire->Recoil_Label->setVisible(true);
     
-    ui->Damaged->setVisible(true);
-    ui->Damaged_Text->setVisible(true);
-    ui->Damaged_Label->setVisible(true);
+    openFire->Damaged->setVisible(true);
+    openFire->Damaged_Text->setVisible(true);
+    openFire->Damaged_Label->setVisible(true);
     
-    ui->Clip->setVisible(true);
-    ui->Clip_Text->setVisible(true);
-    ui->Clip_Label->setVisible(true);
+    openFire->Clip->setVisible(true);
+    openFire->Clip_Text->setVisible(true);
+    openFire->Clip_Label->setVisible(true);
     
-    ui->Ammo->setVisible(true);
-    ui->Ammo_Text->setVisible(true);
-    ui->Ammo_Label->setVisible(true);
+    openFire->Ammo->setVisible(true);
+    openFire->Ammo_Text->setVisible(true);
+    openFire->Ammo_Label->setVisible(true);
     
-    ui->Life->setVisible(true);
-    ui->Life_Text->setVisible(true);
-    ui->Life_Label->setVisible(true);
+    openFire->Life->setVisible(true);
+    openFire->Life_Text->setVisible(true);
+    openFire->Life_Label->setVisible(true);
     
-    ui->Credits->setVisible(true);
-    ui->Credits_Text->setVisible(true);
-    ui->Credits_Label->setVisible(true);
+    openFire->Credits->setVisible(true);
+    openFire->Credits_Text->setVisible(true);
+    openFire->Credits_Label->setVisible(true);
 }
 
 // ---------------------- Other Methods (unchanged logic) ---------------------- //
 
 void MainWindow::prepareDirectories(const QString &basePath, QDir &iniDir, QDir &batDir)
 {
-    // Create an absolute path using QDir to ensure platform compatibility
-    QDir baseDir(basePath);
-    
-    // Make sure base directory exists
-    if (!baseDir.exists()) {
-        if (!baseDir.mkpath(".")) {
-            qWarning() << "Failed to create base directory:" << basePath;
-            return;
-        }
-    }
-    
-    QString iniDirPath = basePath + "/ini";
-    QString batDirPath = basePath + "/bat";
-    
-    iniDir = QDir(iniDirPath);
-    batDir = QDir(batDirPath);
-
-    if (!iniDir.exists()) {
-        if (!iniDir.mkpath(".")) {
-            qWarning() << "Failed to create 'ini' directory:" << iniDirPath;
-        } else {
-            qDebug() << "'ini' directory is ready:" << iniDir.absolutePath();
-        }
-    } else {
-        qDebug() << "'ini' directory is ready:" << iniDir.absolutePath();
-    }
-
-    if (!batDir.exists()) {
-        if (!batDir.mkpath(".")) {
-            qWarning() << "Failed to create 'bat' directory:" << batDirPath;
-        } else {
-            qDebug() << "'bat' directory is ready:" << batDir.absolutePath();
-        }
-    } else {
-        qDebug() << "'bat' directory is ready:" << batDir.absolutePath();
-    }
+    // Use the utility class so the GUI and the headless CLI create the same layout
+    EmulatorUtils::prepareDirectories(basePath, iniDir, batDir);
 }
 
 void MainWindow::mapEmulator(QString &emulator, QString &demulShooterExe)
@@ -734,7 +885,7 @@ QString MainWindow::mapRom(const QString &rom)
     return EmulatorUtils::mapRom(rom);
 }
 
-void MainWindow::createFiles(const QString &rom,
+bool MainWindow::createFiles(const QString &rom,
                              const QString &emulatorInput,
                              QString demulShooterExeInput,
                              const QString &emulatorPath,
@@ -745,44 +896,21 @@ void MainWindow::createFiles(const QString &rom,
                              const QString &iniContent,
                              const QString &batContent)
 {
-    // Mapping and file creation logic remains unchanged.
     Q_UNUSED(emulatorInput);
     Q_UNUSED(demulShooterExeInput);
-    QString rom2 = EmulatorUtils::mapRom(rom);
-    // Log the ROM mapping for debugging
-    qDebug() << "ROM mapping:" << rom << "->" << rom2;
-
-    QDir iniDir, batDir;
     Q_UNUSED(emulatorPath);
     Q_UNUSED(romPath);
     Q_UNUSED(demulShooterPath);
     Q_UNUSED(verbose);
-    prepareDirectories(qmamehookerPath, iniDir, batDir);
-    
-    // Create the BAT file with provided content
-    QString batFilePath = batDir.filePath(rom + ".bat");
-    QFile batFile(batFilePath);
-    if (batFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&batFile);
-        out << batContent;
-        batFile.close();
-        qDebug() << "Batch file created at:" << batFilePath;
-    } else {
-        qWarning() << "Failed to create batch file at:" << batFilePath;
-    }
 
-    // Create the INI file with platform-independent path handling
-    QString iniFilePath = iniDir.filePath(rom2 + ".ini");
-    QFile iniFile(iniFilePath);
-    
-    if (iniFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&iniFile);
-        out << iniContent;
-        iniFile.close();
-        qDebug() << "INI file created at:" << iniFilePath;
-    } else {
-        qWarning() << "Failed to create INI file at:" << iniFilePath;
-    }
+    // Use the utility class to handle writing and fingerprinting the files
+    return EmulatorUtils::createFiles(rom, qmamehookerPath, iniContent, batContent, settingsPath);
+}
+
+void MainWindow::exportFilePaths(const QString &qmamehookerPath, const QString &rom,
+                                 QString &iniFilePath, QString &batFilePath) const
+{
+    EmulatorUtils::exportFilePaths(qmamehookerPath, rom, iniFilePath, batFilePath);
 }
 
 QString MainWindow::generateBatContent(const QString &rom,
@@ -795,48 +923,29 @@ QString MainWindow::generateBatContent(const QString &rom,
                                        const QString &verbose,
                                        const QString &demulShooterArgs)
 {
-    QString emulator = emulatorInput;
-    QString demulShooterExe = demulShooterExeInput;
-    EmulatorUtils::mapEmulator(emulator, demulShooterExe);
-    QString rom2 = EmulatorUtils::mapRom(rom);
+    Q_UNUSED(demulShooterExeInput);
 
     QDir iniDir, batDir;
     prepareDirectories(qmamehookerPath, iniDir, batDir);
 
-    QString iniDirPath = iniDir.absolutePath();
-    QFileInfo emulatorFileInfo(emulatorPath);
-    QString emulatorDirectory = emulatorFileInfo.absolutePath();
-    QString emulatorExecutable = emulatorFileInfo.fileName();
-
-    QString content;
-    QTextStream out(&content);
-    out << "start \"Demul\" \"" << QDir::toNativeSeparators(demulShooterPath + "/" + demulShooterExe)
-        << "\" -target=" << emulator
-        << " -rom=" << rom2;
-    if (!demulShooterArgs.trimmed().isEmpty())
-        out << ' ' << demulShooterArgs.trimmed();
-    out << "\n";
-    out << "start /MIN \"Hooker\" \"" << QDir::toNativeSeparators(qmamehookerPath + "/QMamehook.exe")
-        << "\" -p \"" << QDir::toNativeSeparators(iniDirPath) << "\" " << verbose << " -c \n";
-    out << "cd \"" << QDir::toNativeSeparators(emulatorDirectory) << "\"\n";
-
-    if (emulator == "demul07a") {
-        QString runTarget = EmulatorUtils::demulRunParameter(rom2);
-        out << "start \"demul07a\" \"" << emulatorExecutable << "\" -run=" << runTarget
-            << " -rom=" << rom2;
-    } else if (emulator == "flycast") {
-        out << "start \"" << emulator << "\" " << emulatorExecutable
-            << " -config window:fullscreen=yes \"" << QDir::toNativeSeparators(romPath + "/" + rom2 + ".zip") << "\"";
-    } else if (emulator == "lindbergh" || emulator == "ringwide" || emulator == "rawthrill") {
-        out << "start \"" << emulator << "\" " << emulatorExecutable << " --profile=" << rom2 + ".xml";
-    } else {
-        out << "start \"" << emulator << "\" " << emulatorExecutable << " " << rom2;
-    }
-
-    return content;
+    // Use the utility class so the GUI and the headless CLI generate identical bats
+    return EmulatorUtils::generateBatContent(rom, emulatorInput, emulatorPath, romPath,
+                                             qmamehookerPath, demulShooterPath, verbose,
+                                             demulShooterArgs);
 }
 
 bool MainWindow::exportFiles(bool showMessage)
+{
+    DSQ_TRACE_SPAN("MainWindow::exportFiles");
+    prepareIniForExport();
+    return writeExportFiles(showMessage);
+}
+
+///
+/// Writes the editors' ini and bat as they are; exportFiles() prepares the
+/// ini first.
+///
+bool MainWindow::writeExportFiles(bool showMessage)
 {
     QString emulator = ui->emulatorComboBox->currentText();
     QString emulatorPath = ui->emulatorPathLineEdit->text();
@@ -854,21 +963,37 @@ bool MainWindow::exportFiles(bool showMessage)
         QMessageBox::warning(this, "Path Warning",
                              "You're using Windows-style paths (C:/) on a non-Windows system.\n"
                              "Please use paths appropriate for your operating system.");
-        qWarning() << "Export failed due to invalid path format.";
+        qCWarning(lcExport) << "Export failed due to invalid path format.";
         return false;
     }
     #endif
 
-    createFiles(rom, emulator, QString(), emulatorPath, romPath, qmamehookerPath, demulShooterPath, verbose, iniContent, batContent);
+    QString iniFilePath, batFilePath;
+    exportFilePaths(qmamehookerPath, rom, iniFilePath, batFilePath);
+    QString changes;
+    if (showMessage)
+        changes = describeExportChange(iniFilePath, iniContent, false) + describeExportChange(batFilePath, batContent, false);
+
+    if (!createFiles(rom, emulator, QString(), emulatorPath, romPath, qmamehookerPath, demulShooterPath, verbose, iniContent, batContent)) {
+        if (showMessage)
+            QMessageBox::warning(this, "Export", "Failed to write the batch or INI file.");
+        return false;
+    }
+
+    // What we just wrote is the new disk state; don't report it as an outside change
+    watchLoadedFiles(iniFilePath, batFilePath);
+    if (exportPreview && ui->tabWidget_Advanced->currentWidget() == exportPreview)
+        refreshExportPreview();
 
     if (showMessage)
-        QMessageBox::information(this, "Export", "Batch and INI files have been successfully exported.");
+        QMessageBox::information(this, "Export", "Batch and INI files have been successfully exported.\n\n" + changes);
 
     return true;
 }
 
 void MainWindow::updateGamesList()
 {
+    DSQ_TRACE_SPAN("MainWindow::updateGamesList");
     QString emulator = ui->emulatorComboBox->currentText();
     ui->romComboBox->clear();
     ui->romComboBox->setEnabled(true);
@@ -881,16 +1006,22 @@ void MainWindow::updateGamesList()
     ui->demulShooterArgsLineEdit->clear();
     
     // Set player controls (only Player 1 enabled by default)
-    ui->P1Color->setEnabled(true);
-    ui->P2Color->setEnabled(false);
-    ui->P3Color->setEnabled(false);
-    ui->P4Color->setEnabled(false);
+    if (openFire) {
+        openFire->P1Color->setEnabled(true);
+        openFire->P2Color->setEnabled(false);
+        openFire->P3Color->setEnabled(false);
+        openFire->P4Color->setEnabled(false);
+    }
 
     disconnect(ui->romComboBox, QOverload<const QString &>::of(&QComboBox::currentTextChanged),
                this, &MainWindow::loadIniSettings);
 
-    // Use the utility class to populate the ROM combo box
-    EmulatorUtils::updateGamesList(emulator, ui->romComboBox);
+    // Populate the ROM combo box from the catalog
+    const QStringList games = EmulatorUtils::gamesForEmulator(emulator);
+    if (!games.isEmpty())
+        ui->romComboBox->addItems(games);
+    else
+        ui->romComboBox->setEnabled(false);   // unknown emulator
 
     connect(ui->romComboBox, QOverload<const QString &>::of(&QComboBox::currentTextChanged),
             this, &MainWindow::loadIniSettings);
@@ -899,7 +1030,7 @@ void MainWindow::updateGamesList()
 
 void MainWindow::browseQmamehookerPath()
 {
-    qDebug() << "browseQmamehookerPath triggered";
+    qCDebug(lcExport) << "browseQmamehookerPath triggered";
     QString dir = QFileDialog::getExistingDirectory(this, tr("Select QMamehooker Directory"), ui->qmamehookerPathLineEdit->text(), QFileDialog::DontUseNativeDialog);
     if (!dir.isEmpty()) {
         ui->qmamehookerPathLineEdit->setText(dir);
@@ -908,7 +1039,7 @@ void MainWindow::browseQmamehookerPath()
 
 void MainWindow::browseEmulatorPath()
 {
-    qDebug() << "browseEmulatorPath triggered";
+    qCDebug(lcExport) << "browseEmulatorPath triggered";
     QString file = QFileDialog::getOpenFileName(this, tr("Select Emulator Executable"), ui->emulatorPathLineEdit->text(), tr("Executables (*.exe);;All Files (*)"), nullptr, QFileDialog::DontUseNativeDialog);
     if (!file.isEmpty()) {
         ui->emulatorPathLineEdit->setText(file);
@@ -917,7 +1048,7 @@ void MainWindow::browseEmulatorPath()
 
 void MainWindow::browseRomPath()
 {
-    qDebug() << "browseRomPath triggered";
+    qCDebug(lcExport) << "browseRomPath triggered";
     QString dir = QFileDialog::getExistingDirectory(this, tr("Select ROM Directory"), ui->romPathLineEdit->text(), QFileDialog::DontUseNativeDialog);
     if (!dir.isEmpty()) {
         ui->romPathLineEdit->setText(dir);
@@ -926,341 +1057,294 @@ void MainWindow::browseRomPath()
 
 void MainWindow::browseDemulPath()
 {
-    qDebug() << "browseDemulPath triggered";
+    qCDebug(lcExport) << "browseDemulPath triggered";
     QString dir = QFileDialog::getExistingDirectory(this, tr("Select DemulShooter Directory"), ui->demulShooterPathLineEdit->text(), QFileDialog::DontUseNativeDialog);
     if (!dir.isEmpty()) {
         ui->demulShooterPathLineEdit->setText(dir);
     }
 }
 
-void MainWindow::updateIniText()
+///
+/// Applies the OpenFIRE tab's start command, mode flags, recoil and damage
+/// outputs and LED colours to every ini in the QMamehook folder. Shows which
+/// files would change first; nothing is written unless confirmed.
+///
+void MainWindow::applyToAllGames()
 {
-    // Bail if we're mid-load
-    if (isLoadingIni)
+    DSQ_TRACE_SPAN("MainWindow::applyToAllGames");
+    ensureOpenFireTab();
+
+    // Unset modes ("------") and empty outputs leave each file's own value
+    OpenFireSettings changes = readOpenFireSettings();
+    changes.outputs.clear();
+    const QString recoil = openFire->Recoil_Text->toPlainText().trimmed();
+    if (!recoil.isEmpty())
+        changes.outputs.append(qMakePair(QString("CtmRecoil"), recoil));
+    const QString damaged = openFire->Damaged_Text->toPlainText().trimmed();
+    if (!damaged.isEmpty())
+        changes.outputs.append(qMakePair(QString("Damaged"), damaged));
+
+    const QComboBox *playerColors[] = {openFire->P1Color, openFire->P2Color, openFire->P3Color, openFire->P4Color};
+    for (int i = 0; i < 4; ++i) {
+        if (playerColors[i]->currentIndex() == 0)
+            continue;
+        const QColor color = playerColors[i]->currentData().value<QColor>();
+        changes.ledColors[i].red = color.red();
+        changes.ledColors[i].green = color.green();
+        changes.ledColors[i].blue = color.blue();
+    }
+
+    // The choice is stored as a layer in layers.json; every ini is then
+    // regenerated from the base, emulator and game layers in one pass
+    const QString emulator = ui->emulatorComboBox->currentText();
+    const QString game = ui->romComboBox->currentText();
+    const QString romCode = EmulatorUtils::mapRom(game);
+    QStringList scopes{"Every game (base layer)"};
+    if (!emulator.isEmpty() && !EmulatorUtils::isDivider(emulator))
+        scopes << emulator + " games";
+    if (!romCode.isEmpty())
+        scopes << game + " only";
+    bool chosen = false;
+    const QString scope = QInputDialog::getItem(this, "Apply to All Games", "Apply these settings to:",
+                                                scopes, 0, false, &chosen);
+    if (!chosen)
         return;
 
-    // Only proceed if we already have file content we want to preserve
-    if (!(hasLoadedIni && !originalIniContent.isEmpty()))
+    ConfigLayers layers(settingsPath);
+    layers.load();
+    if (scope == scopes.value(0))
+        layers.mergeIntoLayer(ConfigLayers::Scope::Base, QString(), changes);
+    else if (scope == emulator + " games")
+        layers.mergeIntoLayer(ConfigLayers::Scope::Emulator, emulator, changes);
+    else
+        layers.mergeIntoLayer(ConfigLayers::Scope::Game, romCode, changes);
+
+    const QString iniDir = ui->qmamehookerPathLineEdit->text() + "/ini";
+    const QList<BulkEdit::FileChange> files = layers.preview(iniDir);
+    const QString summary = BulkEdit::summary(files);
+    if (summary.isEmpty()) {
+        if (!layers.save())
+            qCWarning(lcExport) << "Could not save the settings layers next to" << settingsPath;
+        QMessageBox::information(this, "Apply to All Games", "No ini in " + iniDir + " would change.");
         return;
+    }
 
-    /*****  small helpers  *****/
-    auto safeReplaceLine = [](QStringList &lines,
-                              const QString  &keyPrefix,
-                              const QString  &newLine) -> bool
-    {
-        for (int i = 0; i < lines.size(); ++i) {
-            if (lines[i].trimmed().startsWith(keyPrefix, Qt::CaseInsensitive)) {
-                lines[i] = newLine;
-                return true;
-            }
-        }
-        return false;
-    };
+    QMessageBox confirm(QMessageBox::Question, "Apply to All Games",
+                        QString("%1 of %2 ini files in %3 will change (lines added/removed per file below). Write them?")
+                            .arg(summary.count('\n') + 1).arg(files.size()).arg(iniDir),
+                        QMessageBox::Yes | QMessageBox::No, this);
+    confirm.setDetailedText(summary);
+    if (confirm.exec() != QMessageBox::Yes)
+        return;
 
-    auto removeLinesMatching = [](QStringList &lines,
-                                  const QRegularExpression &rx)
-    {
-        for (int i = 0; i < lines.size(); ) {
-            if (rx.match(lines[i]).hasMatch())
-                lines.removeAt(i);        // ← don't ++i here
-            else
-                ++i;
-        }
-    };
+    if (!layers.save())
+        qCWarning(lcExport) << "Could not save the settings layers next to" << settingsPath;
+    const QStringList failures = BulkEdit::commit(files);
+    if (!failures.isEmpty())
+        QMessageBox::warning(this, "Apply to All Games",
+                             "These files were changed by another program or could not be written, and were left as they were:\n"
+                                 + failures.join('\n'));
+
+    // Show the current game as it now is on disk
+    if (!ui->romComboBox->currentText().isEmpty())
+        loadIniSettings(ui->romComboBox->currentText());
+}
 
-    /*****  working copy of the whole file  *****/
-    QString updatedContent = originalIniContent;
-
-    /* -------------------------------------------------------------------- */
-    /* 1.  Detect how many players are in play                              */
-    /* -------------------------------------------------------------------- */
-    int playerCount = 1;
-    if (ui->P4Color->isEnabled())      playerCount = 4;
-    else if (ui->P3Color->isEnabled()) playerCount = 3;
-    else if (ui->P2Color->isEnabled()) playerCount = 2;
-
-    /* -------------------------------------------------------------------- */
-    /* 2.  Update the MameStart line (start flags etc.)                     */
-    /* -------------------------------------------------------------------- */
-    const QMap<QString, QString> startMap = {
-                                             {"S0 - Start with solenoid enabled",          "S0"},
-                                             {"S1 - Start with rumble enabled",            "S1"},
-                                             {"S2 - Start with the RED LED enabled",       "S2"},
-                                             {"S3 - Start with the GREEN LED enabled",     "S3"},
-                                             {"S4 - Start with the BLUE LED enabled",      "S4"},
-                                             {"S6 - Start with everything enabled",        "S6"},
-                                             };
-
-    const QString start = startMap.value(ui->StartCommands->currentText());
-
-    if (!start.isEmpty()) {
-        QRegularExpression mameStartRx(R"(MameStart\s*=\s*(.*))");
-        auto match = mameStartRx.match(updatedContent);
-        if (match.hasMatch()) {
-            QString mameStartLine  = match.captured(0);
-            QString mameStartValue = match.captured(1);
-
-            // Build mode flags string from UI selections
-            QStringList modeFlags;
-
-            // Device Output Mode
-            if (ui->DeviceOutputMode->currentText().contains("M0x")) {
-                QString mode = ui->DeviceOutputMode->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
+///
+/// Starts span recording, or saves what was recorded as Chrome trace JSON
+/// (open in chrome://tracing or ui.perfetto.dev) and stops.
+///
+void MainWindow::toggleTrace()
+{
+    if (!DsqTrace::isEnabled()) {
+        DsqTrace::clear();
+        DsqTrace::setEnabled(true);
+        QMessageBox::information(this, "Trace", "Tracing started. Press Ctrl+Shift+T again to save the trace.");
+        return;
+    }
 
-            // Offscreen Firing Mode
-            if (ui->OffscreenFiringMode->currentText().contains("M1x")) {
-                QString mode = ui->OffscreenFiringMode->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
+    DsqTrace::setEnabled(false);
+    const QString fileName = QFileDialog::getSaveFileName(this, tr("Save Trace"), "dsq-trace.json",
+                                                          tr("Chrome trace (*.json)"), nullptr,
+                                                          QFileDialog::DontUseNativeDialog);
+    if (fileName.isEmpty())
+        return;
+    if (!DsqTrace::writeChromeTrace(fileName))
+        QMessageBox::warning(this, "Trace", "Failed to save the trace to " + fileName);
+}
 
-            // Pedal Mapping
-            if (ui->PedalMapping->currentText().contains("M2x")) {
-                QString mode = ui->PedalMapping->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
-
-            // Aspect Ratio Correction
-            if (ui->AspectRatioCorrection->currentText().contains("M3x")) {
-                QString mode = ui->AspectRatioCorrection->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
+///
+/// The OpenFIRE tab combo box for each OpenFireFlags family, in table order.
+///
+QList<QPair<const OpenFireFlags::Family *, QComboBox *>> MainWindow::flagCombos() const
+{
+    const QPair<QString OpenFireSettings::*, QComboBox *> combos[] = {
+        {&OpenFireSettings::startCommand, openFire->StartCommands},
+        {&OpenFireSettings::deviceMode, openFire->DeviceOutputMode},
+        {&OpenFireSettings::offscreenMode, openFire->OffscreenFiringMode},
+        {&OpenFireSettings::pedalMode, openFire->PedalMapping},
+        {&OpenFireSettings::aspectMode, openFire->AspectRatioCorrection},
+        {&OpenFireSettings::rumbleMode, openFire->RumbleOnlyMode},
+        {&OpenFireSettings::autoFireMode, openFire->AutoFireMode},
+        {&OpenFireSettings::displayMode, openFire->DisplayMode},
+    };
+    QList<QPair<const OpenFireFlags::Family *, QComboBox *>> result;
+    for (const OpenFireFlags::Family &family : OpenFireFlags::families()) {
+        for (const auto &combo : combos) {
+            if (combo.first == family.field)
+                result.append(qMakePair(&family, combo.second));
+        }
+    }
+    return result;
+}
 
-            // Rumble Only Mode
-            if (ui->RumbleOnlyMode->currentText().contains("M6x")) {
-                QString mode = ui->RumbleOnlyMode->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
+///
+/// Builds the OpenFIRE tab the first time it is shown, or before the editor
+/// is exported, launched or previewed. The new widgets are filled from the
+/// editor, which may hold edits made before the tab existed, and the game's
+/// saved output choices are applied on top, as loading with the tab open does.
+///
+void MainWindow::ensureOpenFireTab()
+{
+    if (openFire)
+        return;
+    DSQ_TRACE_SPAN("MainWindow::ensureOpenFireTab");
 
-            // Auto Fire Mode
-            if (ui->AutoFireMode->currentText().contains("M8x")) {
-                QString mode = ui->AutoFireMode->currentText().mid(0, 4);
-                modeFlags << mode;
-            }
+    openFire = new Ui::OpenFireTab;
+    QWidget *content = new QWidget(ui->tab_OpenFIRE);
+    openFire->setupUi(content);
+    ui->tab_OpenFIRE->layout()->addWidget(content);
+    // Show now rather than on the next event loop pass: filling the tab below
+    // checks which outputs are visible.
+    content->show();
 
-            // Display Mode
-            if (ui->DisplayMode->currentText().contains("MDx")) {
-                QString mode = ui->DisplayMode->currentText();
-                if (mode.contains("MDx3B")) {
-                    modeFlags << "MDx3B";
-                } else {
-                    modeFlags << mode.mid(0, 4);
-                }
-            }
+    setupOpenFireFields();
+    setupColorComboBoxes();
+    resetOpenFireFields();
+    setupOpenFireConnections();
+
+    const QString editorText = ui->plainTextEdit_Generic->toPlainText();
+    if (hasLoadedIni && !editorText.isEmpty()) {
+        originalIniContent = editorText;
+        applyOpenFireSettings(originalIniContent, profiles.profileOrDefault(profileRom));
+        // Filling the tab is not an edit the user can undo
+        iniHistory.reset(ui->plainTextEdit_Generic->toPlainText());
+    }
+}
 
-            QString modeFlagsStr = modeFlags.join('x');
-            if (!modeFlagsStr.isEmpty()) {
-                modeFlagsStr = 'x' + modeFlagsStr;
-            }
+///
+/// Brings the editor to the ini Export writes: the OpenFIRE tab and the
+/// game's profile applied, then whatever layers.json sets for the game, as
+/// Apply to All Games and the headless CLI write it.
+///
+void MainWindow::prepareIniForExport()
+{
+    if (!hasLoadedIni)
+        return;
+    ensureOpenFireTab();
 
-            // Split the MameStart value into individual commands
-            QStringList commands = mameStartValue.split(',');
-            QStringList newCommands;
-
-            for (const QString &cmd : commands) {
-                QString trimmedCmd = cmd.trimmed();
-                
-                // Handle cmw commands (player-specific commands)
-                if (trimmedCmd.startsWith("cmw")) {
-                    QRegularExpression playerCmdRx(R"(cmw\s+(\d+)\s+(?:S[0-6])?(?:x[^,\s]*)?)");
-                    auto playerMatch = playerCmdRx.match(trimmedCmd);
-                    
-                    if (playerMatch.hasMatch()) {
-                        int player = playerMatch.captured(1).toInt();
-                        // Add both start flag and mode flags
-                        newCommands.append(QString("cmw %1 %2%3").arg(player).arg(start).arg(modeFlagsStr));
-                    } else {
-                        newCommands.append(trimmedCmd);
-                    }
-                } else if (trimmedCmd.startsWith("\"cmo")) {
-                    // Keep cmo commands with quotes
-                    newCommands.append(trimmedCmd);
-                } else if (trimmedCmd.startsWith("cmo")) {
-                    // Add quotes around cmo commands
-                    newCommands.append(QString("\"%1\"").arg(trimmedCmd));
-                } else {
-                    // Keep other commands unchanged
-                    newCommands.append(trimmedCmd);
-                }
-            }
+    const QString romCode = EmulatorUtils::mapRom(ui->romComboBox->currentText());
+    ConfigLayers layers(settingsPath);
+    if (romCode.isEmpty() || !layers.load())
+        return;
+    const QString current = ui->plainTextEdit_Generic->toPlainText();
+    // Only what the layers set is written; everything else stays as edited
+    const QString layered = BulkEdit::transform(current, layers.resolve(romCode));
+    if (layered == current)
+        return;
 
-            // Reconstruct the MameStart line
-            QString newStartValue = newCommands.join(", ");
-            updatedContent.replace(mameStartLine, "MameStart = " + newStartValue);
-        }
-    }
+    qCDebug(lcExport) << "Applying settings layers to" << romCode;
+    originalIniContent = layered;
+    setIniEditorText(layered);
+    // The tab shows the layered values; the editor already holds the ini
+    applyOpenFireSettings(layered, QJsonObject(), false);
+}
 
-    /* -------------------------------------------------------------------- */
-    /* 3.  Re-write the [General] section, preserving Flags line            */
-    /* -------------------------------------------------------------------- */
-    const int generalPos = updatedContent.indexOf("[General]");
-    if (generalPos >= 0) {
-        int nextPos = updatedContent.indexOf("[", generalPos + 1);
-        if (nextPos < 0) nextPos = updatedContent.length();
-
-        QStringList lines = updatedContent.mid(generalPos,
-                                               nextPos - generalPos).split('\n');
-
-        // Keep only non-mode-flag lines and preserve Flags line
-        QStringList newLines;
-        for (const QString &line : lines) {
-            QString trimmed = line.trimmed();
-            if (!trimmed.startsWith("M0x") && !trimmed.startsWith("M1x") && 
-                !trimmed.startsWith("M2x") && !trimmed.startsWith("M3x") &&
-                !trimmed.startsWith("M6x") && !trimmed.startsWith("M8x") &&
-                !trimmed.startsWith("MDx")) {
-                newLines.append(line);
-            }
-        }
+///
+/// Collects the OpenFIRE tab into an OpenFireSettings for OpenFireConfig::apply.
+///
+OpenFireSettings MainWindow::readOpenFireSettings() const
+{
+    OpenFireSettings settings;
 
-        // Stitch the cleaned list back together
-        QString newGeneral = newLines.join('\n').trimmed() + '\n';
-        updatedContent.replace(generalPos, nextPos - generalPos, newGeneral);
-    }
+    if (openFire->P4Color->isEnabled())      settings.playerCount = 4;
+    else if (openFire->P3Color->isEnabled()) settings.playerCount = 3;
+    else if (openFire->P2Color->isEnabled()) settings.playerCount = 2;
 
-    /* -------------------------------------------------------------------- */
-    /* 4.  Helper to write Output-section keys (Recoil, Damage, etc.)        */
-    /* -------------------------------------------------------------------- */
-    auto writePlayerKey = [&](const QString &templateKey,
-                              const QString &value)
-    {
-        if (value.isEmpty()) return;
-
-        QStringList lines = updatedContent.split('\n');
-        bool   modified   = false;
-
-        for (int player = 1; player <= playerCount; ++player) {
-            // skip disabled colours
-            bool enabled = (player == 1 && ui->P1Color->isEnabled()) ||
-                           (player == 2 && ui->P2Color->isEnabled()) ||
-                           (player == 3 && ui->P3Color->isEnabled()) ||
-                           (player == 4 && ui->P4Color->isEnabled());
-            if (!enabled) continue;
-
-            const QString key = QString(templateKey).arg(player);
-            const QString newLine =
-                QString("%1 = cmw %2 %3").arg(key).arg(player).arg(value);
-
-            if (!safeReplaceLine(lines, key, newLine)) {
-                // key didn't exist – append it just inside [Output]
-                int outPos = lines.indexOf(QRegularExpression(R"(\[Output\])"));
-                if (outPos >= 0)
-                    lines.insert(outPos + 1, newLine);
-            }
-            modified = true;
-        }
+    for (const auto &flagCombo : flagCombos())
+        settings.*flagCombo.first->field = OpenFireFlags::codeAt(*flagCombo.first, flagCombo.second->currentIndex());
 
-        if (modified)
-            updatedContent = lines.join('\n');
+    // Output values: the text field wins, otherwise the preset behind the combo
+    auto addOutput = [&settings](const QString &key, const QComboBox *combo, const QTextEdit *text,
+                                 const QMap<QString, QString> &presets) {
+        if (combo->isHidden())
+            return;
+        const QString value = !text->toPlainText().isEmpty() ? text->toPlainText()
+                                                             : presets.value(combo->currentText());
+        settings.outputs.append(qMakePair(key, value));
     };
 
-    /* 4a –- Recoil ------------------------------------------------------- */
-    const QMap<QString, QString> recoilMap = {
-                                              {"------", ""},
+    addOutput("CtmRecoil", openFire->Recoil, openFire->Recoil_Text, {
                                               {"Solenoid Single Pulse (recommended)",       "F0x2x1"},
                                               {"Solenoid Switching",                        "F0x%s%"},
                                               {"Rumble Single Pulse (recommended for rumble)", "F1x2x1"},
                                               {"Rumble Switching",                          "F1x%s%"},
-                                              };
-    writePlayerKey("P%1_CtmRecoil",
-                   ui->Recoil->isVisible()
-                       ? (!ui->Recoil_Text->toPlainText().isEmpty()
-                              ? ui->Recoil_Text->toPlainText()
-                              : recoilMap.value(ui->Recoil->currentText()))
-                       : "");
-
-    /* 4b –- Damage ------------------------------------------------------- */
-    const QMap<QString, QString> damageMap = {
-                                              {"------", ""},
+                                              });
+    addOutput("Damaged", openFire->Damaged, openFire->Damaged_Text, {
                                               {"Rumble Single Pulse (recommended)", "F1x2x1"},
                                               {"Rumble Switching",                  "F1x%s%"},
-                                              };
-    writePlayerKey("P%1_Damaged",
-                   ui->Damaged->isVisible()
-                       ? (!ui->Damaged_Text->toPlainText().isEmpty()
-                              ? ui->Damaged_Text->toPlainText()
-                              : damageMap.value(ui->Damaged->currentText()))
-                       : "");
-
-    /* 4c –- Clip --------------------------------------------------------- */
-    writePlayerKey("P%1_Clip",
-                   ui->Clip->isVisible()
-                       ? (!ui->Clip_Text->toPlainText().isEmpty()
-                              ? ui->Clip_Text->toPlainText()
-                              : (ui->Clip->currentText() == "Red/Off" ? "XX" : ""))
-                       : "");
-
-    /* 4d –- Ammo --------------------------------------------------------- */
-    writePlayerKey("P%1_Ammo",
-                   ui->Ammo->isVisible()
-                       ? (!ui->Ammo_Text->toPlainText().isEmpty()
-                              ? ui->Ammo_Text->toPlainText()
-                              : (ui->Ammo->currentText() == "OLED On" ? "DFAx%s%" : ""))
-                       : "");
-
-    /* 4e –- Life --------------------------------------------------------- */
-    writePlayerKey("P%1_Life",
-                   ui->Life->isVisible()
-                       ? (!ui->Life_Text->toPlainText().isEmpty()
-                              ? ui->Life_Text->toPlainText()
-                              : (ui->Life->currentText() == "OLED On" ? "DFLx%s%" : ""))
-                       : "");
-
-    /* 4f –- Credits (single key) ---------------------------------------- */
-    if (ui->Credits->isVisible()) {
-        const QString credits =
-            !ui->Credits_Text->toPlainText().isEmpty()
-                ? ui->Credits_Text->toPlainText()
-                : (ui->Credits->currentText() == "OLED On (coming soon)" ? "XX" : "");
-
-        if (!credits.isEmpty()) {
-            QStringList lines = updatedContent.split('\n');
-            if (!safeReplaceLine(lines, "Credits", "Credits = cmw 1 " + credits)) {
-                int outPos = lines.indexOf(QRegularExpression(R"(\[Output\])"));
-                if (outPos >= 0)
-                    lines.insert(outPos + 1, "Credits = cmw 1 " + credits);
-            }
-            updatedContent = lines.join('\n');
-        }
-    }
-
-    /* -------------------------------------------------------------------- */
-    /* 5.  Custom 1-3 (same helper)                                         */
-    /* -------------------------------------------------------------------- */
-    auto handleCustom = [&](QComboBox *cb,
-                            QTextEdit  *txt,
-                            QLabel     *label,        // ← was QLineEdit*
-                            const QString &defaultName)
-    {
-        if (!cb->isVisible() || label->text() == defaultName)
+                                              });
+    addOutput("Clip", openFire->Clip, openFire->Clip_Text, {{"Red/Off", "XX"}});
+    addOutput("Ammo", openFire->Ammo, openFire->Ammo_Text, {{"OLED On", "DFAx%s%"}});
+    addOutput("Life", openFire->Life, openFire->Life_Text, {{"OLED On", "DFLx%s%"}});
+    addOutput("Credits", openFire->Credits, openFire->Credits_Text, {{"OLED On (coming soon)", "XX"}});
+
+    // Custom 1-3 write under the key shown in their label
+    auto addCustom = [&settings](const QComboBox *cb, const QTextEdit *txt,
+                                 const QLabel *label, const QString &defaultName) {
+        if (cb->isHidden() || label->text() == defaultName)
             return;
-
         const QString value =
             !txt->toPlainText().isEmpty() ? txt->toPlainText()
                                           : (cb->currentText() == "------"
                                                  ? ""
                                                  : cb->currentText());
-
-        if (value.isEmpty()) return;
-
-        const QString settingName = label->text();
-        writePlayerKey("P%1_" + settingName, value);
+        settings.outputs.append(qMakePair(label->text(), value));
     };
 
-    handleCustom(ui->Custom1, ui->Custom1_Text, ui->lineEdit,   "Custom 1.");
-    handleCustom(ui->Custom2, ui->Custom2_Text, ui->lineEdit_2, "Custom 2.");
-    handleCustom(ui->Custom3, ui->Custom3_Text, ui->lineEdit_3, "Custom 3.");
+    addCustom(openFire->Custom1, openFire->Custom1_Text, openFire->lineEdit,   "Custom 1.");
+    addCustom(openFire->Custom2, openFire->Custom2_Text, openFire->lineEdit_2, "Custom 2.");
+    addCustom(openFire->Custom3, openFire->Custom3_Text, openFire->lineEdit_3, "Custom 3.");
 
-    /* -------------------------------------------------------------------- */
-    /* 6.  Push the updated text back to the UI                             */
-    /* -------------------------------------------------------------------- */
-    ui->plainTextEdit_Generic->setPlainText(updatedContent);
+    return settings;
 }
 
+void MainWindow::updateIniText()
+{
+    DSQ_TRACE_SPAN("MainWindow::updateIniText");
+    ++counters.updateIniText;
+
+    // Bail if we're mid-load
+    if (isLoadingIni)
+        return;
+
+    // Only proceed if we already have file content we want to preserve
+    if (!(hasLoadedIni && !originalIniContent.isEmpty()))
+        return;
+
+    // Nothing on the OpenFIRE tab can have changed before it is built
+    if (!openFire)
+        return;
+
+    // The rewrite itself lives in OpenFireConfig so the CLI produces identical files
+    ++counters.iniRegenerations;
+    const QString updatedContent = OpenFireConfig::apply(originalIniContent, readOpenFireSettings());
+    setIniEditorText(updatedContent);
+}
 
 void MainWindow::updateEmulatorPath()
 {
+    DSQ_TRACE_SPAN("MainWindow::updateEmulatorPath");
     QString emulator = ui->emulatorComboBox->currentText();
     QString emulatorPath, romPath;
     
@@ -1283,76 +1367,46 @@ void MainWindow::updateEmulatorPath()
 
 void MainWindow::loadIniSettings(const QString &romName)
 {
+    DSQ_TRACE_SPAN("MainWindow::loadIniSettings");
+    ++counters.loadIniSettings;
+
+    // Finish saving the previous game's choices before its widgets change
+    if (profileDirty)
+        saveOutputProfile();
+    profileRom.clear();
+    profileDirty = false;
+
     // Reset INI state when changing ROMs
     originalIniContent = "";
     hasLoadedIni = false;
     ui->plainTextEdit_Generic->clear();
     ui->plainTextEdit_Bat->clear();
-
-    // Always hide custom fields - they will be edited in the text editor
-    ui->lineEdit->setVisible(false);
-    ui->Custom1->setVisible(false);
-    ui->Custom1_Text->setVisible(false);
-    ui->lineEdit_2->setVisible(false);
-    ui->Custom2->setVisible(false);
-    ui->Custom2_Text->setVisible(false);
-    ui->lineEdit_3->setVisible(false);
-    ui->Custom3->setVisible(false);
-    ui->Custom3_Text->setVisible(false);
+    watchLoadedFiles(QString(), QString());
 
     QString rom2 = EmulatorUtils::mapRom(romName);
     if (rom2.isEmpty()) return;
 
     QString qmamehookerPath = ui->qmamehookerPathLineEdit->text();
-    QString iniPath = qmamehookerPath + "/ini/" + rom2 + ".ini";
-    QFile iniFile(iniPath);
-
-    QString defaultHeader = "[General]\n"
-                          "MameStart=\"cmo 1 baud=9600_parity=N_data=8_stop=1\", \"cmo 2 baud=9600_parity=N_data=8_stop=1\", cmw 1 S6, cmw 2 S6\n"
-                          "MameStop=cmw 1 E, cmw 2 E, cmc 1, cmc 2\n"
-                          "StateChange=\n"
-                          "OnRotate=\n"
-                          "OnPause=\n\n"
-                          "[KeyStates]\n"
-                          "RefreshTime=\n\n";
-
-    QString iniContent;
-    if (iniFile.exists()) {
-        if (iniFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            iniContent = iniFile.readAll();
-            iniFile.close();
-
-            // Check if [General] section exists
-            if (!iniContent.contains("[General]")) {
-                // Add default header at the start
-                iniContent = defaultHeader + iniContent;
-            }
-        }
-    } else {
-        // If file doesn't exist, start with default header
-        iniContent = defaultHeader;
-    }
+    // Load and watch the same files Export writes
+    QString iniPath, batPath;
+    exportFilePaths(qmamehookerPath, romName, iniPath, batPath);
+
+    QString iniContent = EmulatorUtils::loadIniContent(iniPath);
+    // The arguments below are read back from the bat being loaded
+    const QSignalBlocker blockArgs(ui->demulShooterArgsLineEdit);
 
     // Store the original INI content for structure preservation
     originalIniContent = iniContent;
     hasLoadedIni = true;
 
     // Load the INI file content
-    ui->plainTextEdit_Generic->setPlainText(iniContent);
+    setIniEditorText(iniContent);
 
     // Load or generate BAT file content
-    QString batPath = qmamehookerPath + "/bat/" + rom2 + ".bat";
     QString batContent;
-    QFile batFile(batPath);
-    if (batFile.exists() && batFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        batContent = batFile.readAll();
-        batFile.close();
-        QStringList batLines = batContent.split('\n');
-        if (!batLines.isEmpty()) {
-            QRegularExpression argsRegex(R"(start\s+"Demul"\s+".*"\s+-target=[^\s]+\s+-rom=[^\s]+\s*(.*))", QRegularExpression::CaseInsensitiveOption);
-            auto match = argsRegex.match(batLines[0]);
-            if (match.hasMatch()) ui->demulShooterArgsLineEdit->setText(match.captured(1).trimmed());
-        }
+    if (TextFile::read(batPath, batContent)) {
+        QString args;
+        if (EmulatorUtils::demulShooterArgsFromBat(batContent, args)) ui->demulShooterArgsLineEdit->setText(args);
     } else {
         QString verbose = (ui->verboseComboBox->currentText() == "Yes") ? "-v" : "";
         batContent = generateBatContent(romName,
@@ -1367,486 +1421,420 @@ void MainWindow::loadIniSettings(const QString &romName)
     }
     ui->plainTextEdit_Bat->setPlainText(batContent);
 
-    // Load General settings first
-    int generalSectionPos = iniContent.indexOf("[General]");
-    if (generalSectionPos >= 0) {
-        // Find the end of the General section
-        int nextSectionPos = iniContent.indexOf("[", generalSectionPos + 1);
-        if (nextSectionPos < 0) nextSectionPos = iniContent.length();
-
-        // Extract the General section
-        QString generalSection = iniContent.mid(generalSectionPos, nextSectionPos - generalSectionPos);
-
-        qDebug() << "Loaded General section:" << generalSection;
-
-        // Look for each of the General section settings with more flexible regex patterns
-
-        // First, extract any mode flags from the MameStart command
-        QRegularExpression mameStartRegex(R"(MameStart\s*=.*?cmw\s+\d+\s+S\d+(?:x(?:[^,\s]+))*)");
-        auto mameStartMatch = mameStartRegex.match(generalSection);
-
-        QString modeFlags;
-        if (mameStartMatch.hasMatch()) {
-            QString startCommand = mameStartMatch.captured(0);
-            // Extract the part after S6x (or any S command)
-            QRegularExpression flagsRegex(R"(S\d+(x.+)(?=\s|,|$))");
-            auto flagsMatch = flagsRegex.match(startCommand);
-            if (flagsMatch.hasMatch()) {
-                modeFlags = flagsMatch.captured(1);
-                // Remove the leading 'x' if present
-                if (modeFlags.startsWith('x')) {
-                    modeFlags.remove(0, 1);
-                }
-                qDebug() << "Extracted mode flags from MameStart:" << modeFlags;
-            }
-        }
+    // Until the OpenFIRE tab is built (first view, export, launch or preview)
+    // the editor is the only view of the ini
+    profileRom = rom2;
+    if (openFire) {
+        applyOpenFireSettings(iniContent, profiles.profileOrDefault(rom2));
+    }
 
-        // Device Output Mode (M0)
-        // Match M0x0, M0x1, M0x1L, M0x2 etc. allowing for optional spaces and other characters around it
-        QRegularExpression deviceModeRegex(R"((?:^|x)M0x(\d+L?)(?:$|x))");
-        auto deviceMatch = deviceModeRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (deviceMatch.hasMatch()) {
-            QString value = deviceMatch.captured(1);
-            QString fullMatch = "M0x" + value;
-            qDebug() << "Found Device Mode:" << fullMatch;
-
-
-            if (value == "0") {
-                ui->DeviceOutputMode->setCurrentText("M0x0 - Mouse & Keyboard");
-            } else if (value == "1") {
-                ui->DeviceOutputMode->setCurrentText("M0x1 - Gamepad, w/ Camera mapped to Right Stick");
-            } else if (value == "1L") {
-                ui->DeviceOutputMode->setCurrentText("M0x1L - Maps Camera to Left Stick instead (OpenFIRE exclusive)");
-            } else if (value == "2") {
-                ui->DeviceOutputMode->setCurrentText("M0x2 - 'Hybrid'");
-            } else {
-                ui->DeviceOutputMode->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            qDebug() << "Device Mode not found";
-            ui->DeviceOutputMode->setCurrentIndex(0); // Default to first item
-        }
+    // A new game starts a new history, from the ini as the tab left it
+    iniHistory.reset(ui->plainTextEdit_Generic->toPlainText());
+    watchLoadedFiles(iniPath, batPath);
+}
 
-        // Offscreen Firing Mode (M1)
-        QRegularExpression offscreenRegex(R"((?:^|x)M1x(\d+)(?:$|x))");
-        auto offscreenMatch = offscreenRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (offscreenMatch.hasMatch()) {
-            QString value = offscreenMatch.captured(1);
-            QString fullMatch = "M1x" + value;
-            qDebug() << "Found Offscreen Mode:" << fullMatch;
-
-            if (value == "0") {
-                ui->OffscreenFiringMode->setCurrentText("M1x0 - Disabled (not used in OpenFIRE)");
-            } else if (value == "1") {
-                ui->OffscreenFiringMode->setCurrentText("M1x1 - Fire in bottom-left corner (not used in OpenFIRE)");
-            } else if (value == "2") {
-                ui->OffscreenFiringMode->setCurrentText("M1x2 - Offscreen Button Mode enabled (i.e. offscreen trigger pulls generates a Right Click instead of a Left Click)");
-            } else if (value == "3") {
-                ui->OffscreenFiringMode->setCurrentText("M1x3 - Normal shot (always on when Offscreen Button Mode isn't set in OpenFIRE)");
-            } else {
-                ui->OffscreenFiringMode->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            qDebug() << "Offscreen Mode not found";
-            ui->OffscreenFiringMode->setCurrentIndex(0); // Default to first item
-        }
+///
+/// Watches the current game's ini and bat for changes made by other
+/// programs, and takes the current disk and editor contents as the point
+/// to compare against. Empty paths stop watching.
+///
+void MainWindow::watchLoadedFiles(const QString &iniPath, const QString &batPath)
+{
+    if (!fileWatcher->files().isEmpty())
+        fileWatcher->removePaths(fileWatcher->files());
+    pendingFileChanges.clear();
+
+    watchedIniPath = iniPath;
+    watchedBatPath = batPath;
+    diskIniContent = QFileInfo::exists(iniPath) ? EmulatorUtils::loadIniContent(iniPath) : QString();
+    diskBatContent = readTextFile(batPath);
+    iniEditorBaseline = ui->plainTextEdit_Generic->toPlainText();
+    batEditorBaseline = ui->plainTextEdit_Bat->toPlainText();
+
+    for (const QString &path : {iniPath, batPath}) {
+        if (!path.isEmpty() && QFileInfo::exists(path))
+            fileWatcher->addPath(path);
+    }
+}
 
-        // Pedal Mapping (M2)
-        QRegularExpression pedalRegex(R"((?:^|x)M2x(\d+)(?:$|x))");
-        auto pedalMatch = pedalRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (pedalMatch.hasMatch()) {
-            QString value = pedalMatch.captured(1);
-            QString fullMatch = "M2x" + value;
-            qDebug() << "Found Pedal Mode:" << fullMatch;
-
-            if (value == "0") {
-                ui->PedalMapping->setCurrentText("M2x0 - Separate Button (as mapped)");
-            } else if (value == "1") {
-                ui->PedalMapping->setCurrentText("M2x1 - As Right Mouse");
-            } else if (value == "2") {
-                ui->PedalMapping->setCurrentText("M2x2 - As Middle Mouse (OpenFIRE exclusive)");
-            } else {
-                ui->PedalMapping->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            qDebug() << "Pedal Mode not found";
-            ui->PedalMapping->setCurrentIndex(0); // Default to first item
-        }
+///
+/// A bat or ini as text in its own encoding; empty when path is empty or
+/// cannot be read.
+///
+QString MainWindow::readTextFile(const QString &path)
+{
+    QString content;
+    if (!path.isEmpty())
+        TextFile::read(path, content);
+    return content;
+}
 
-        // Aspect Ratio Correction (M3)
-        QRegularExpression aspectRegex(R"((?:^|x)M3x(\d+)(?:$|x))");
-        auto aspectMatch = aspectRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (aspectMatch.hasMatch()) {
-            QString value = aspectMatch.captured(1);
-            QString fullMatch = "M3x" + value;
-            qDebug() << "Found Aspect Ratio Mode:" << fullMatch;
-
-            if (value == "0") {
-                ui->AspectRatioCorrection->setCurrentText("M3x0 - Fullscreen");
-            } else if (value == "1") {
-                ui->AspectRatioCorrection->setCurrentText("M3x1 - 4:3 Correction");
-            } else {
-                ui->AspectRatioCorrection->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            qDebug() << "Aspect Ratio Mode not found";
-            ui->AspectRatioCorrection->setCurrentIndex(0); // Default to first item
-        }
+///
+/// Hands the editor text to the validator on its worker. An edit made while a
+/// run is in progress makes that result stale; it is dropped and this runs again.
+///
+void MainWindow::startValidation()
+{
+    if (validationRunning) {
+        validationPending = true;
+        return;
+    }
+    validationRunning = true;
+    const QString text = ui->plainTextEdit_Generic->toPlainText();
+    validationPool.start([this, text]() {
+        const QList<CommandValidator::Problem> problems = validator.validate(text);
+        QMetaObject::invokeMethod(this, [this, problems]() { showValidation(problems); }, Qt::QueuedConnection);
+    });
+}
 
-        // Rumble Only Mode (M6)
-        QRegularExpression rumbleRegex(R"((?:^|x)M6x(\d+)(?:$|x))");
-        auto rumbleMatch = rumbleRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (rumbleMatch.hasMatch()) {
-            QString value = rumbleMatch.captured(1);
-            QString fullMatch = "M6x" + value;
-            qDebug() << "Found Rumble Only Mode:" << fullMatch;
-
-            if (value == "0") {
-                ui->RumbleOnlyMode->setCurrentText("M6x0 - Disabled (Solenoid allowed)");
-            } else if (value == "1") {
-                ui->RumbleOnlyMode->setCurrentText("M6x1 - Enabled (Solenoid disabled, Rumble enabled)");
-            } else {
-                ui->RumbleOnlyMode->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            qDebug() << "Rumble Only Mode not found";
-            ui->RumbleOnlyMode->setCurrentIndex(0); // Default to first item
-        }
+///
+/// Underlines the problems found in the current editor text.
+///
+void MainWindow::showValidation(const QList<CommandValidator::Problem> &problems)
+{
+    validationRunning = false;
+    if (validationPending) {
+        validationPending = false;
+        startValidation();
+        return;
+    }
+    if (validationTimer->isActive())
+        return; // edited since; the next run is already scheduled
+
+    iniProblems = problems;
+    QTextCharFormat underline;
+    underline.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+    underline.setUnderlineColor(Qt::red);
+
+    QList<QTextEdit::ExtraSelection> selections;
+    QTextDocument *document = ui->plainTextEdit_Generic->document();
+    for (const CommandValidator::Problem &problem : problems) {
+        const QTextBlock block = document->findBlockByNumber(problem.line);
+        if (!block.isValid())
+            continue;
+        QTextEdit::ExtraSelection selection;
+        const int lineEnd = block.position() + block.length() - 1;
+        selection.format = underline;
+        selection.cursor = QTextCursor(document);
+        selection.cursor.setPosition(qMin(block.position() + problem.column, lineEnd));
+        selection.cursor.setPosition(qMin(block.position() + problem.column + problem.length, lineEnd),
+                                     QTextCursor::KeepAnchor);
+        selections.append(selection);
+    }
+    ui->plainTextEdit_Generic->setExtraSelections(selections);
+    showProblemAtCursor();
+}
 
-        // Auto Fire Mode (M8)
-        QRegularExpression autoFireRegex(R"((?:^|x)M8x(\d+)(?:$|x))");
-        auto autoFireMatch = autoFireRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (autoFireMatch.hasMatch()) {
-            QString value = autoFireMatch.captured(1);
-            QString fullMatch = "M8x" + value;
-            qDebug() << "Found Auto Fire Mode:" << fullMatch;
-
-            if (value == "0") {
-                ui->AutoFireMode->setCurrentText("M8x0 - Disabled (sustained fire is kept enabled in OpenFIRE)");
-            } else if (value == "1") {
-                ui->AutoFireMode->setCurrentText("M8x1 - Auto fire on (enables Burst Fire in OpenFIRE)");
-            } else if (value == "2") {
-                ui->AutoFireMode->setCurrentText("M8x2 - Auto fire always on rapid fire");
-            } else {
-                ui->AutoFireMode->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            ui->AutoFireMode->setCurrentIndex(0); // Default to first item
+///
+/// Puts the first problem on the cursor's line in the status bar.
+///
+void MainWindow::showProblemAtCursor()
+{
+    const int line = ui->plainTextEdit_Generic->textCursor().blockNumber();
+    for (const CommandValidator::Problem &problem : iniProblems) {
+        if (problem.line == line) {
+            ui->statusbar->showMessage(QString("Line %1: %2").arg(line + 1).arg(problem.message));
+            return;
         }
+    }
+    ui->statusbar->clearMessage();
+}
 
-        // Display Mode (MD)
-        QRegularExpression displayRegex(R"((?:^|x)MDx(\d+)(?:B)?(?:$|x))");
-        auto displayMatch = displayRegex.match(modeFlags.isEmpty() ? generalSection : modeFlags);
-        if (displayMatch.hasMatch()) {
-            QString value = displayMatch.captured(1);
-            QString fullCapture = displayMatch.captured(0);
-            QString fullMatch = fullCapture.contains("B") ? "MDx" + value + "B" : "MDx" + value;
-            qDebug() << "Found Display Mode:" << fullMatch;
-
-            if (value == "1") {
-                ui->DisplayMode->setCurrentText("MDx1 - Life Only");
-            } else if (value == "2") {
-                ui->DisplayMode->setCurrentText("MDx2 - Ammo Only");
-            } else if (value == "3") {
-                if (fullCapture.contains("MDx3B")) {
-                    ui->DisplayMode->setCurrentText("MDx3B - Life Bar (Life Glyphs otherwise)");
-                } else {
-                    ui->DisplayMode->setCurrentText("MDx3 - Life & Ammo Splitscreen");
-                }
-            } else {
-                ui->DisplayMode->setCurrentIndex(0); // Default to first item
-            }
-        } else {
-            ui->DisplayMode->setCurrentIndex(0); // Default to first item
-        }
+///
+/// One line saying how writing content to path changes it, followed by the
+/// unified diff when withDiff is set.
+///
+QString MainWindow::describeExportChange(const QString &path, const QString &content, bool withDiff)
+{
+    const QString name = QFileInfo(path).fileName();
+    if (!QFileInfo::exists(path))
+        return QString("%1: new file, %2 lines\n").arg(name).arg(content.isEmpty() ? 0 : content.count('\n') + 1);
+
+    const QString disk = readTextFile(path);
+    const LineDiff::Counts counts = LineDiff::count(disk, content);
+    if (counts.isEmpty())
+        return name + ": unchanged\n";
+    QString description = QString("%1: +%2 -%3\n").arg(name).arg(counts.added).arg(counts.removed);
+    if (withDiff)
+        description += LineDiff::unified(disk, content, path + " (on disk)", path + " (export)") + '\n';
+    return description;
+}
 
-        // Start Command (S)
-        QRegularExpression startRegex(R"(MameStart\s*=.*?cmw\s+\d+\s+(S[0-6])(?:x|[\s,]))");
-        auto startMatch = startRegex.match(iniContent);
-        if (startMatch.hasMatch()) {
-            QString value = startMatch.captured(1);
-            qDebug() << "Updating Start Commands dropdown to:" << value;
-            if (value == "S0") {
-                ui->StartCommands->setCurrentText("S0 - Start with solenoid enabled");
-            } else if (value == "S1") {
-                ui->StartCommands->setCurrentText("S1 - Start with rumble enabled");
-            } else if (value == "S2") {
-                ui->StartCommands->setCurrentText("S2 - Start with the RED LED enabled");
-            } else if (value == "S3") {
-                ui->StartCommands->setCurrentText("S3 - Start with the GREEN LED enabled");
-            } else if (value == "S4") {
-                ui->StartCommands->setCurrentText("S4 - Start with the BLUE LED enabled");
-            } else if (value == "S6") {
-                ui->StartCommands->setCurrentText("S6 - Start with everything enabled");
-            } else {
-                ui->StartCommands->setCurrentIndex(5); // Default to S6
-            }
-            qDebug() << "Updating Start Commands dropdown to:" << ui->StartCommands->currentText();
-        } else {
-            ui->StartCommands->setCurrentIndex(5); // Default to S6
-        }
+///
+/// Shows what Export would change for the selected game.
+///
+void MainWindow::refreshExportPreview()
+{
+    DSQ_TRACE_SPAN("MainWindow::refreshExportPreview");
+    const QString rom = ui->romComboBox->currentText();
+    if (EmulatorUtils::mapRom(rom).isEmpty()) {
+        exportPreview->setPlainText(tr("Select a game to preview its export."));
+        return;
     }
 
-    // Detect the number of players in the INI file
-    int playerCount = 0; // Default to 0 player, we'll set it to at least 1 later
-
-    // First, check if there's an [Output] section
-    int outputSectionPos = iniContent.indexOf("[Output]");
-    if (outputSectionPos >= 0) {
-        // Find the end of the Output section
-        int nextSectionPos = iniContent.indexOf("[", outputSectionPos + 1);
-        if (nextSectionPos < 0) nextSectionPos = iniContent.length();
-
-        // Extract the Output section
-        QString outputSection = iniContent.mid(outputSectionPos, nextSectionPos - outputSectionPos);
-
-        // Check for player entries using various patterns
-    QSet<int> foundPlayers;
-
-        // Pattern for P1_Something, Player1_Something, etc.
-        QRegularExpression playerPattern(R"(P(\d+)(?:_|\s*=|\s+))");
-        auto playerMatches = playerPattern.globalMatch(outputSection);
-        while (playerMatches.hasNext()) {
-            auto match = playerMatches.next();
-        bool ok;
-        int player = match.captured(1).toInt(&ok);
-        if (ok && player > 0) {
-            foundPlayers.insert(player);
-        }
+    QString iniFilePath, batFilePath;
+    exportFilePaths(ui->qmamehookerPathLineEdit->text(), rom, iniFilePath, batFilePath);
+    prepareIniForExport();
+    const int scroll = exportPreview->verticalScrollBar()->value();
+    exportPreview->setPlainText(describeExportChange(iniFilePath, ui->plainTextEdit_Generic->toPlainText(), true)
+                                + describeExportChange(batFilePath, ui->plainTextEdit_Bat->toPlainText(), true));
+    exportPreview->verticalScrollBar()->setValue(scroll);
+}
+
+///
+/// Picks up external edits to the watched files, a short while after the
+/// last change notification so half-written files are not read.
+///
+void MainWindow::reloadChangedFiles()
+{
+    const QSet<QString> paths = pendingFileChanges;
+    pendingFileChanges.clear();
+
+    for (const QString &path : paths) {
+        if (!QFileInfo::exists(path))
+            continue;
+        // Editors that save by replacing the file drop it from the watcher
+        if (!fileWatcher->files().contains(path))
+            fileWatcher->addPath(path);
+
+        if (path == watchedIniPath)
+            reloadIniFromDisk();
+        else if (path == watchedBatPath)
+            reloadBatFromDisk();
     }
+}
 
-        // Pattern for Player1, Player 1, etc.
-        QRegularExpression player2Pattern(R"(Player\s*(\d+)(?:_|\s*=|\s+))");
-        auto player2Matches = player2Pattern.globalMatch(outputSection);
-        while (player2Matches.hasNext()) {
-            auto match = player2Matches.next();
-            bool ok;
-            int player = match.captured(1).toInt(&ok);
-            if (ok && player > 0) {
-                foundPlayers.insert(player);
-            }
-        }
+///
+/// True when the user agrees to replace their unsaved edits with the file
+/// another program just changed.
+///
+bool MainWindow::confirmReload(const QString &path)
+{
+    return QMessageBox::question(this, "File Changed",
+                                 QFileInfo(path).fileName() + " was changed by another program.\n\n"
+                                 "Reload it and discard your edits here? Choose No to keep your version; "
+                                 "exporting will then overwrite the other change.")
+           == QMessageBox::Yes;
+}
 
-        // Also check MameStart line for player indicators
-        QRegularExpression mameStartRegex(R"(MameStart\s*=\s*(?:.*cmw\s+(\d+).*))");
-        auto mameStartMatches = mameStartRegex.globalMatch(iniContent);
-        while (mameStartMatches.hasNext()) {
-            auto match = mameStartMatches.next();
-        bool ok;
-        int player = match.captured(1).toInt(&ok);
-        if (ok && player > 0) {
-            foundPlayers.insert(player);
-        }
-    }
+void MainWindow::reloadIniFromDisk()
+{
+    DSQ_TRACE_SPAN("MainWindow::reloadIniFromDisk");
+    const QString disk = EmulatorUtils::loadIniContent(watchedIniPath);
+    if (disk == diskIniContent)
+        return; // our own export, or only touched
+
+    const bool localEdits = ui->plainTextEdit_Generic->toPlainText() != iniEditorBaseline;
+    diskIniContent = disk;
+    if (localEdits && !confirmReload(watchedIniPath))
+        return;
 
-        // If we found players, determine the max player count
-    if (!foundPlayers.isEmpty()) {
-        playerCount = *std::max_element(foundPlayers.begin(), foundPlayers.end());
-        }
-    }
+    // Only the ini changes; the bat, paths and the rest of the UI stay as they are
+    qCDebug(lcIni) << "Reloading ini changed on disk:" << watchedIniPath;
+    originalIniContent = disk;
+    hasLoadedIni = true;
+    setIniEditorText(disk);
+    if (openFire)
+        applyOpenFireSettings(disk);
+    iniEditorBaseline = ui->plainTextEdit_Generic->toPlainText();
+    iniHistory.reset(iniEditorBaseline);
+}
 
-    // Ensure at least 1 player
-    playerCount = qMax(1, playerCount);
+void MainWindow::reloadBatFromDisk()
+{
+    DSQ_TRACE_SPAN("MainWindow::reloadBatFromDisk");
+    const QString disk = readTextFile(watchedBatPath);
+    if (disk == diskBatContent)
+        return;
 
-    qDebug() << "Detected" << playerCount << "players in the INI file";
+    const bool localEdits = ui->plainTextEdit_Bat->toPlainText() != batEditorBaseline;
+    diskBatContent = disk;
+    if (localEdits && !confirmReload(watchedBatPath))
+        return;
 
-    // Enable or disable player controls based on detected player count
-    ui->P1Color->setEnabled(playerCount >= 1);
-    ui->P2Color->setEnabled(playerCount >= 2);
-    ui->P3Color->setEnabled(playerCount >= 3);
-    ui->P4Color->setEnabled(playerCount >= 4);
-
-    // Detect existing settings in the INI file
-    QMap<QString, QSet<int>> settingsMap; // Maps setting name to player numbers
-
-    // Scan for all settings in the [Output] section
-    if (outputSectionPos >= 0) {
-        int nextSectionPos = iniContent.indexOf("[", outputSectionPos + 1);
-        if (nextSectionPos < 0) nextSectionPos = iniContent.length();
-
-        QString outputSection = iniContent.mid(outputSectionPos, nextSectionPos - outputSectionPos);
-
-        // Find all player-based settings (P1_Something, P2_Something, etc.)
-        QRegularExpression settingPattern(R"(P(\d+)_(\w+)\s*=)");
-        auto settingMatches = settingPattern.globalMatch(outputSection);
-
-        while (settingMatches.hasNext()) {
-            auto match = settingMatches.next();
-            bool ok;
-            int player = match.captured(1).toInt(&ok);
-            if (ok && player > 0) {
-                QString settingName = match.captured(2);
-                if (!settingsMap.contains(settingName)) {
-                    settingsMap[settingName] = QSet<int>();
-                }
-                settingsMap[settingName].insert(player);
-            }
-        }
+    qCDebug(lcIni) << "Reloading bat changed on disk:" << watchedBatPath;
+    ui->plainTextEdit_Bat->setPlainText(disk);
+    QString args;
+    if (EmulatorUtils::demulShooterArgsFromBat(disk, args)) {
+        const QSignalBlocker blockArgs(ui->demulShooterArgsLineEdit);
+        ui->demulShooterArgsLineEdit->setText(args);
     }
+    batEditorBaseline = ui->plainTextEdit_Bat->toPlainText();
+}
 
-    // Check if we need to hide any existing settings or add new ones
-    QStringList knownSettings = {"CtmRecoil", "Damaged", "Clip", "Ammo", "Life", "Credits"};
-
-    // Hide/disable settings that don't exist in the INI file
-    for (const QString& setting : knownSettings) {
-        bool hasAnySetting = settingsMap.contains(setting);
-
-        // If the setting exists for at least one player
-        if (hasAnySetting) {
-            // Check which specific UI component to update
-            if (setting == "CtmRecoil") {
-                ui->Recoil->setVisible(true);
-                ui->Recoil_Text->setVisible(true);
-                ui->Recoil_Label->setVisible(true);
-            } else if (setting == "Damaged") {
-                ui->Damaged->setVisible(true);
-                ui->Damaged_Text->setVisible(true);
-                ui->Damaged_Label->setVisible(true);
-            } else if (setting == "Clip") {
-                ui->Clip->setVisible(true);
-                ui->Clip_Text->setVisible(true);
-                ui->Clip_Label->setVisible(true);
-            } else if (setting == "Ammo") {
-                ui->Ammo->setVisible(true);
-                ui->Ammo_Text->setVisible(true);
-                ui->Ammo_Label->setVisible(true);
-            } else if (setting == "Life") {
-                ui->Life->setVisible(true);
-                ui->Life_Text->setVisible(true);
-                ui->Life_Label->setVisible(true);
-            } else if (setting == "Credits") {
-                ui->Credits->setVisible(true);
-                ui->Credits_Text->setVisible(true);
-                ui->Credits_Label->setVisible(true);
-            }
-        } else {
-            // If the setting doesn't exist, hide the corresponding UI elements
-            if (setting == "CtmRecoil") {
-                ui->Recoil->setVisible(false);
-                ui->Recoil_Text->setVisible(false);
-                ui->Recoil_Label->setVisible(false);
-            } else if (setting == "Damaged") {
-                ui->Damaged->setVisible(false);
-                ui->Damaged_Text->setVisible(false);
-                ui->Damaged_Label->setVisible(false);
-            } else if (setting == "Clip") {
-                ui->Clip->setVisible(false);
-                ui->Clip_Text->setVisible(false);
-                ui->Clip_Label->setVisible(false);
-            } else if (setting == "Ammo") {
-                ui->Ammo->setVisible(false);
-                ui->Ammo_Text->setVisible(false);
-                ui->Ammo_Label->setVisible(false);
-            } else if (setting == "Life") {
-                ui->Life->setVisible(false);
-                ui->Life_Text->setVisible(false);
-                ui->Life_Label->setVisible(false);
-            } else if (setting == "Credits") {
-                ui->Credits->setVisible(false);
-                ui->Credits_Text->setVisible(false);
-                ui->Credits_Label->setVisible(false);
-            }
-        }
+///
+/// Sets the OpenFIRE tab from an INI: modes, player colours and outputs, then
+/// the game's saved output choices when a profile is given. With regenerate
+/// false the editor is left as it is.
+///
+void MainWindow::applyOpenFireSettings(const QString &iniContent, const QJsonObject &profile, bool regenerate)
+{
+    DSQ_TRACE_SPAN("MainWindow::applyOpenFireSettings");
+
+    // Load as one transaction: no per-widget signals (each would rewrite the
+    // ini), then a single regeneration once every widget is set.
+    isLoadingIni = true;
+    std::vector<QSignalBlocker> blockers;
+    for (QWidget *widget : ui->tab_OpenFIRE->findChildren<QWidget *>())
+        blockers.emplace_back(widget);
+
+    // Always hide custom fields - they will be edited in the text editor
+    openFire->lineEdit->setVisible(false);
+    openFire->Custom1->setVisible(false);
+    openFire->Custom1_Text->setVisible(false);
+    openFire->lineEdit_2->setVisible(false);
+    openFire->Custom2->setVisible(false);
+    openFire->Custom2_Text->setVisible(false);
+    openFire->lineEdit_3->setVisible(false);
+    openFire->Custom3->setVisible(false);
+    openFire->Custom3_Text->setVisible(false);
+
+    // Load General settings first
+    const OpenFireSettings settings = OpenFireConfig::parse(iniContent);
+    if (iniContent.contains("[General]")) {
+        qCDebug(lcIni) << "Loaded mode flags:" << settings.modeFlags();
+
+        // Unset flags show "------", or S6 for the start command
+        for (const auto &flagCombo : flagCombos())
+            flagCombo.second->setCurrentIndex(OpenFireFlags::itemIndex(*flagCombo.first, settings.*flagCombo.first->field));
+        qCDebug(lcIni) << "Updating Start Commands dropdown to:" << openFire->StartCommands->currentText();
     }
 
-    // Remove the custom field handling section
-    // Check for custom settings that are not in our predefined list
-    for (auto it = settingsMap.begin(); it != settingsMap.end(); ++it) {
-        QString settingName = it.key();
-        if (!knownSettings.contains(settingName) && settingName != "LmpStart") {
-            // Only log that we found a custom setting
-            qDebug() << "Found custom setting:" << settingName;
-        }
+    const int playerCount = settings.playerCount;
+    qCDebug(lcIni) << "Detected" << playerCount << "players in the INI file";
+
+    // Enable or disable player controls based on detected player count
+    openFire->P1Color->setEnabled(playerCount >= 1);
+    openFire->P2Color->setEnabled(playerCount >= 2);
+    openFire->P3Color->setEnabled(playerCount >= 3);
+    openFire->P4Color->setEnabled(playerCount >= 4);
+
+    // Hide settings that don't exist in the INI file
+    const bool hasRecoil = settings.presentSettings.contains("CtmRecoil");
+    openFire->Recoil->setVisible(hasRecoil);
+    openFire->Recoil_Text->setVisible(hasRecoil);
+    openFire->Recoil_Label->setVisible(hasRecoil);
+
+    const bool hasDamaged = settings.presentSettings.contains("Damaged");
+    openFire->Damaged->setVisible(hasDamaged);
+    openFire->Damaged_Text->setVisible(hasDamaged);
+    openFire->Damaged_Label->setVisible(hasDamaged);
+
+    const bool hasClip = settings.presentSettings.contains("Clip");
+    openFire->Clip->setVisible(hasClip);
+    openFire->Clip_Text->setVisible(hasClip);
+    openFire->Clip_Label->setVisible(hasClip);
+
+    const bool hasAmmo = settings.presentSettings.contains("Ammo");
+    openFire->Ammo->setVisible(hasAmmo);
+    openFire->Ammo_Text->setVisible(hasAmmo);
+    openFire->Ammo_Label->setVisible(hasAmmo);
+
+    const bool hasLife = settings.presentSettings.contains("Life");
+    openFire->Life->setVisible(hasLife);
+    openFire->Life_Text->setVisible(hasLife);
+    openFire->Life_Label->setVisible(hasLife);
+
+    const bool hasCredits = settings.presentSettings.contains("Credits");
+    openFire->Credits->setVisible(hasCredits);
+    openFire->Credits_Text->setVisible(hasCredits);
+    openFire->Credits_Label->setVisible(hasCredits);
+
+    // Custom settings are edited in the text editor; only log them
+    const QStringList knownSettings = {"CtmRecoil", "Damaged", "Clip", "Ammo", "Life", "Credits", "LmpStart"};
+    for (const QString &settingName : settings.presentSettings) {
+        if (!knownSettings.contains(settingName))
+            qCDebug(lcIni) << "Found custom setting:" << settingName;
     }
 
     // Extract specific parameters for the UI controls
     // Update Recoil settings if they're visible
-    if (ui->Recoil->isVisible()) {
-    auto recoilMatch = recoilRegex.match(iniContent);
-    if (recoilMatch.hasMatch()) {
-        QString value = recoilMatch.captured(1).trimmed();
-        ui->Recoil_Text->setPlainText(value);
-        if (value == "F0x2x1") ui->Recoil->setCurrentText("Solenoid Single Pulse (recommended)");
-        else if (value == "F0x%s%") ui->Recoil->setCurrentText("Solenoid Switching");
-        else if (value == "F1x2x1") ui->Recoil->setCurrentText("Rumble Single Pulse (recommended for rumble)");
-        else if (value == "F1x%s%") ui->Recoil->setCurrentText("Rumble Switching");
-        else { ui->Recoil->setCurrentText("Custom"); ui->Recoil_Text->setPlainText(value); }
-    } else {
-        ui->Recoil_Text->clear();
-        ui->Recoil->setCurrentText("------");
+    if (!openFire->Recoil->isHidden()) {
+        if (settings.hasOutput("CtmRecoil")) {
+            const QString value = settings.outputValue("CtmRecoil");
+            openFire->Recoil_Text->setPlainText(value);
+            if (value == "F0x2x1") openFire->Recoil->setCurrentText("Solenoid Single Pulse (recommended)");
+            else if (value == "F0x%s%") openFire->Recoil->setCurrentText("Solenoid Switching");
+            else if (value == "F1x2x1") openFire->Recoil->setCurrentText("Rumble Single Pulse (recommended for rumble)");
+            else if (value == "F1x%s%") openFire->Recoil->setCurrentText("Rumble Switching");
+            else { openFire->Recoil->setCurrentText("Custom"); openFire->Recoil_Text->setPlainText(value); }
+        } else {
+            openFire->Recoil_Text->clear();
+            openFire->Recoil->setCurrentText("------");
         }
     }
 
     // Update Damaged settings if they're visible
-    if (ui->Damaged->isVisible()) {
-    auto damageMatch = damageRegex.match(iniContent);
-    if (damageMatch.hasMatch()) {
-        QString value = damageMatch.captured(1).trimmed();
-        ui->Damaged_Text->setPlainText(value);
-        if (value == "F1x2x1") ui->Damaged->setCurrentText("Rumble Single Pulse (recommended)");
-        else if (value == "F1x%s%") ui->Damaged->setCurrentText("Rumble Switching");
-        else { ui->Damaged->setCurrentText("Custom"); ui->Damaged_Text->setPlainText(value); }
-    } else {
-        ui->Damaged_Text->clear();
-        ui->Damaged->setCurrentText("------");
+    if (!openFire->Damaged->isHidden()) {
+        if (settings.hasOutput("Damaged")) {
+            const QString value = settings.outputValue("Damaged");
+            openFire->Damaged_Text->setPlainText(value);
+            if (value == "F1x2x1") openFire->Damaged->setCurrentText("Rumble Single Pulse (recommended)");
+            else if (value == "F1x%s%") openFire->Damaged->setCurrentText("Rumble Switching");
+            else { openFire->Damaged->setCurrentText("Custom"); openFire->Damaged_Text->setPlainText(value); }
+        } else {
+            openFire->Damaged_Text->clear();
+            openFire->Damaged->setCurrentText("------");
         }
     }
 
     // Update Clip settings if they're visible
-    if (ui->Clip->isVisible()) {
-    auto clipMatch = clipRegex.match(iniContent);
-    if (clipMatch.hasMatch()) {
-        QString value = clipMatch.captured(1).trimmed();
-        ui->Clip_Text->setPlainText(value);
-        if (value == "XX") ui->Clip->setCurrentText("Red/Off");
-        else { ui->Clip->setCurrentText("Custom"); ui->Clip_Text->setPlainText(value); }
-    } else {
-        ui->Clip_Text->clear();
-        ui->Clip->setCurrentText("------");
+    if (!openFire->Clip->isHidden()) {
+        if (settings.hasOutput("Clip")) {
+            const QString value = settings.outputValue("Clip");
+            openFire->Clip_Text->setPlainText(value);
+            if (value == "XX") openFire->Clip->setCurrentText("Red/Off");
+            else { openFire->Clip->setCurrentText("Custom"); openFire->Clip_Text->setPlainText(value); }
+        } else {
+            openFire->Clip_Text->clear();
+            openFire->Clip->setCurrentText("------");
         }
     }
 
     // Update Ammo settings if they're visible
-    if (ui->Ammo->isVisible()) {
-    auto ammoMatch = ammoRegex.match(iniContent);
-    if (ammoMatch.hasMatch()) {
-        QString value = ammoMatch.captured(1).trimmed();
-        ui->Ammo_Text->setPlainText(value);
-        if (value == "DFAx%s%") ui->Ammo->setCurrentText("OLED On");
-        else { ui->Ammo->setCurrentText("Custom"); ui->Ammo_Text->setPlainText(value); }
-    } else {
-        ui->Ammo_Text->clear();
-        ui->Ammo->setCurrentText("------");
+    if (!openFire->Ammo->isHidden()) {
+        if (settings.hasOutput("Ammo")) {
+            const QString value = settings.outputValue("Ammo");
+            openFire->Ammo_Text->setPlainText(value);
+            if (value == "DFAx%s%") openFire->Ammo->setCurrentText("OLED On");
+            else { openFire->Ammo->setCurrentText("Custom"); openFire->Ammo_Text->setPlainText(value); }
+        } else {
+            openFire->Ammo_Text->clear();
+            openFire->Ammo->setCurrentText("------");
         }
     }
 
     // Update Life settings if they're visible
-    if (ui->Life->isVisible()) {
-    auto lifeMatch = lifeRegex.match(iniContent);
-    if (lifeMatch.hasMatch()) {
-        QString value = lifeMatch.captured(1).trimmed();
-        ui->Life_Text->setPlainText(value);
-        if (value == "XX") ui->Life->setCurrentText("OLED On");
-        else { ui->Life->setCurrentText("Custom"); ui->Life_Text->setPlainText(value); }
-    } else {
-        ui->Life_Text->clear();
-        ui->Life->setCurrentText("------");
+    if (!openFire->Life->isHidden()) {
+        if (settings.hasOutput("Life")) {
+            const QString value = settings.outputValue("Life");
+            openFire->Life_Text->setPlainText(value);
+            if (value == "XX") openFire->Life->setCurrentText("OLED On");
+            else { openFire->Life->setCurrentText("Custom"); openFire->Life_Text->setPlainText(value); }
+        } else {
+            openFire->Life_Text->clear();
+            openFire->Life->setCurrentText("------");
         }
     }
 
     // Update Credits settings
-    auto creditsMatch = creditsRegex.match(iniContent);
-    if (creditsMatch.hasMatch()) {
-        QString value = creditsMatch.captured(1).trimmed();
-        ui->Credits_Text->setPlainText(value);
-        if (value == "XX") ui->Credits->setCurrentText("OLED On (coming soon)");
-        else { ui->Credits->setCurrentText("Custom"); ui->Credits_Text->setPlainText(value); }
+    if (settings.hasOutput("Credits")) {
+        const QString value = settings.outputValue("Credits");
+        openFire->Credits_Text->setPlainText(value);
+        if (value == "XX") openFire->Credits->setCurrentText("OLED On (coming soon)");
+        else { openFire->Credits->setCurrentText("Custom"); openFire->Credits_Text->setPlainText(value); }
     } else {
-        ui->Credits_Text->clear();
-        ui->Credits->setCurrentText("------");
+        openFire->Credits_Text->clear();
+        openFire->Credits->setCurrentText("------");
     }
 
     updateAllComboBoxes();
+    restoreOutputProfile(profile);
+
+    blockers.clear();
+    isLoadingIni = false;
+    if (regenerate)
+        updateIniText();
 }
 
 void MainWindow::updateTextBox(const QString &text) {
@@ -1854,205 +1842,54 @@ void MainWindow::updateTextBox(const QString &text) {
 }
 
 void MainWindow::refreshIni() {
+    DSQ_TRACE_SPAN("MainWindow::refreshIni");
     QString romName = ui->romComboBox->currentText();
     if (!romName.isEmpty()) {
         // Reset UI state before reloading
         setupDefaultIni();
 
-        // Load the INI for the selected ROM
+        // Load the INI for the selected ROM (this also syncs the dropdowns)
         loadIniSettings(romName);
-        updateAllComboBoxes();
 
-        qDebug() << "INI and BAT files refreshed for ROM:" << romName;
+        qCDebug(lcIni) << "INI and BAT files refreshed for ROM:" << romName;
     } else {
-        qDebug() << "No ROM selected to refresh INI.";
+        qCDebug(lcIni) << "No ROM selected to refresh INI.";
     }
 }
 
 // Add this function after loadIniSettings
 
 void MainWindow::updateAllComboBoxes() {
+    DSQ_TRACE_SPAN("MainWindow::updateAllComboBoxes");
+    if (!openFire)
+        return;
+
     // Make sure all dropdowns are properly set based on their current values
     // This helps ensure the UI state matches the INI file settings
     
     // Update the player color dropdowns from LmpStart commands in the INI
     if (hasLoadedIni && !originalIniContent.isEmpty()) {
-        // Get the max player count
-        int playerCount = 1;
-        if (ui->P4Color->isEnabled()) playerCount = 4;
-        else if (ui->P3Color->isEnabled()) playerCount = 3;
-        else if (ui->P2Color->isEnabled()) playerCount = 2;
-        
-        for (int player = 1; player <= playerCount; player++) {
-            QComboBox* playerColor = nullptr;
-            if (player == 1) playerColor = ui->P1Color;
-            else if (player == 2) playerColor = ui->P2Color;
-            else if (player == 3) playerColor = ui->P3Color;
-            else if (player == 4) playerColor = ui->P4Color;
-            
-            if (playerColor && playerColor->isEnabled()) {
-                // Define regex pattern to extract RGB values from LmpStart command
-                QRegularExpression lmpPattern(QString(R"(P%1_LmpStart\s*=\s*cmw\s+%1\s+F2x1x(\d+)xF3x1x(\d+)xF4x1x(\d+))").arg(player));
-                auto lmpMatch = lmpPattern.match(originalIniContent);
-                
-                if (lmpMatch.hasMatch()) {
-                    // Extract RGB values from the LmpStart command
-                    int red = lmpMatch.captured(1).toInt();
-                    int green = lmpMatch.captured(2).toInt();
-                    int blue = lmpMatch.captured(3).toInt();
-                    QColor color(red, green, blue);
-                    
-                    qDebug() << QString("Found Player %1 color: RGB(%2,%3,%4)").arg(player).arg(red).arg(green).arg(blue);
-                    
-                    // Find the matching color in the dropdown
-                    bool foundColor = false;
-                    for (int i = 0; i < playerColor->count(); i++) {
-                        QColor itemColor = playerColor->itemData(i).value<QColor>();
-                        if (itemColor.red() == red && itemColor.green() == green && itemColor.blue() == blue) {
-                            playerColor->setCurrentIndex(i);
-                            foundColor = true;
-                            break;
-                        }
-                    }
-                    
-                    // If exact color not found, set to closest color or add a custom color option
-                    if (!foundColor && playerColor->count() > 0) {
-                        // Add custom color option if it doesn't exactly match
-                        // Use the first entry for now (default "------" option)
-                        playerColor->setCurrentIndex(0);
-                    }
-                } else {
-                    // If no LmpStart command found, set to default (first item in dropdown)
-                    playerColor->setCurrentIndex(0);
-                }
-            }
-        }
-    }
-    
-    // Manually trigger update signals for all relevant combo boxes
-    // Device Output Mode
-    QString deviceText = ui->DeviceOutputMode->currentText();
-    if (deviceText.contains("M0x")) {
-        qDebug() << "Updating Device Mode dropdown to:" << deviceText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->DeviceOutputMode->count(); i++) {
-            if (ui->DeviceOutputMode->itemText(i).contains(deviceText.left(4))) {
-                ui->DeviceOutputMode->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Offscreen Firing Mode
-    QString offscreenText = ui->OffscreenFiringMode->currentText();
-    if (offscreenText.contains("M1x")) {
-        qDebug() << "Updating Offscreen Mode dropdown to:" << offscreenText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->OffscreenFiringMode->count(); i++) {
-            if (ui->OffscreenFiringMode->itemText(i).contains(offscreenText.left(4))) {
-                ui->OffscreenFiringMode->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Pedal Mapping
-    QString pedalText = ui->PedalMapping->currentText();
-    if (pedalText.contains("M2x")) {
-        qDebug() << "Updating Pedal Mode dropdown to:" << pedalText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->PedalMapping->count(); i++) {
-            if (ui->PedalMapping->itemText(i).contains(pedalText.left(4))) {
-                ui->PedalMapping->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Aspect Ratio Correction
-    QString aspectText = ui->AspectRatioCorrection->currentText();
-    if (aspectText.contains("M3x")) {
-        qDebug() << "Updating Aspect Ratio dropdown to:" << aspectText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->AspectRatioCorrection->count(); i++) {
-            if (ui->AspectRatioCorrection->itemText(i).contains(aspectText.left(4))) {
-                ui->AspectRatioCorrection->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Rumble Only Mode
-    QString rumbleText = ui->RumbleOnlyMode->currentText();
-    if (rumbleText.contains("M6x")) {
-        qDebug() << "Updating Rumble Mode dropdown to:" << rumbleText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->RumbleOnlyMode->count(); i++) {
-            if (ui->RumbleOnlyMode->itemText(i).contains(rumbleText.left(4))) {
-                ui->RumbleOnlyMode->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Auto Fire Mode
-    QString autoFireText = ui->AutoFireMode->currentText();
-    if (autoFireText.contains("M8x")) {
-        qDebug() << "Updating Auto Fire Mode dropdown to:" << autoFireText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->AutoFireMode->count(); i++) {
-            if (ui->AutoFireMode->itemText(i).contains(autoFireText.left(4))) {
-                ui->AutoFireMode->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Display Mode
-    QString displayText = ui->DisplayMode->currentText();
-    if (displayText.contains("MDx")) {
-        qDebug() << "Updating Display Mode dropdown to:" << displayText;
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->DisplayMode->count(); i++) {
-            if (ui->DisplayMode->itemText(i).contains(displayText.left(5))) {
-                ui->DisplayMode->setCurrentIndex(i);
-                break;
-            }
-        }
-    }
-    
-    // Start Commands
-    QString startText = ui->StartCommands->currentText();
-    if (startText.contains("S")) {
-        qDebug() << "Updating Start Commands dropdown to:" << startText;
-        
-        // Get just the S command part (S0, S1, etc.)
-        QString sCommand = "";
-        for (int i = 0; i < startText.length(); i++) {
-            if (startText[i] == 'S' && i+1 < startText.length() && startText[i+1].isDigit()) {
-                sCommand = startText.mid(i, 2);
-                break;
-            }
-        }
-        
-        // Select an item if it's not already selected
-        for (int i = 0; i < ui->StartCommands->count(); i++) {
-            if (ui->StartCommands->itemText(i).contains(sCommand)) {
-                ui->StartCommands->setCurrentIndex(i);
-                break;
+        const std::array<LedColor, 4> colors = OpenFireConfig::lmpStartColors(originalIniContent);
+        QComboBox *const playerColors[] = {openFire->P1Color, openFire->P2Color, openFire->P3Color, openFire->P4Color};
+        for (int player = 1; player <= 4; ++player) {
+            QComboBox *playerColor = playerColors[player - 1];
+            if (!playerColor->isEnabled())
+                continue;
+
+            // No LmpStart, or a colour the dropdown doesn't offer, shows the first item
+            const LedColor &led = colors[player - 1];
+            int index = 0;
+            if (led.isValid()) {
+                qCDebug(lcIni) << QString("Found Player %1 color: RGB(%2,%3,%4)").arg(player).arg(led.red).arg(led.green).arg(led.blue);
+                index = ledColorIndex.value(qRgb(led.red, led.green, led.blue), 0);
             }
+            playerColor->setCurrentIndex(index);
         }
     }
 }
 
 void MainWindow::updateBatCommandLine() {
+    DSQ_TRACE_SPAN("MainWindow::updateBatCommandLine");
     QString emulatorFriendly = ui->emulatorComboBox->currentText();
     QString emulator = emulatorFriendly;
     QString demulShooterExe;
@@ -2075,9 +1912,16 @@ void MainWindow::updateBatCommandLine() {
 }
 
 void MainWindow::loadSettings() {
-    const QString settingsPath = QDir(QCoreApplication::applicationDirPath()).filePath("settings.ini");
+    DSQ_TRACE_SPAN("MainWindow::loadSettings");
     QSettings settings(settingsPath, QSettings::IniFormat);
 
+    // Restoring values is not an edit; nothing should regenerate here
+    const QSignalBlocker blockEmulatorPath(ui->emulatorPathLineEdit);
+    const QSignalBlocker blockRomPath(ui->romPathLineEdit);
+    const QSignalBlocker blockDemulPath(ui->demulShooterPathLineEdit);
+    const QSignalBlocker blockHookPath(ui->qmamehookerPathLineEdit);
+    const QSignalBlocker blockArgs(ui->demulShooterArgsLineEdit);
+
     settings.beginGroup("Paths");
     ui->emulatorPathLineEdit->setText(settings.value("Emulator", ui->emulatorPathLineEdit->text()).toString());
     ui->romPathLineEdit->setText(settings.value("Roms", ui->romPathLineEdit->text()).toString());
@@ -2089,72 +1933,114 @@ void MainWindow::loadSettings() {
     ui->demulShooterArgsLineEdit->setText(settings.value("DemulShooterArgs", ui->demulShooterArgsLineEdit->text()).toString());
     settings.endGroup();
 
+    // Older versions kept one set of output choices for every game. It becomes
+    // the default profile, and is only dropped from settings.ini once saved.
     settings.beginGroup("Outputs");
-    auto safeSetIndex = [](QComboBox *combo, int index) {
-        if (!combo) return;
-        if (index >= 0 && index < combo->count()) {
-            combo->setCurrentIndex(index);
-        }
-    };
-
-    {
-        QSignalBlocker blockP1(ui->P1Color);
-        QSignalBlocker blockP2(ui->P2Color);
-        QSignalBlocker blockP3(ui->P3Color);
-        QSignalBlocker blockP4(ui->P4Color);
-        safeSetIndex(ui->P1Color, settings.value("P1ColorIndex", ui->P1Color->currentIndex()).toInt());
-        safeSetIndex(ui->P2Color, settings.value("P2ColorIndex", ui->P2Color->currentIndex()).toInt());
-        safeSetIndex(ui->P3Color, settings.value("P3ColorIndex", ui->P3Color->currentIndex()).toInt());
-        safeSetIndex(ui->P4Color, settings.value("P4ColorIndex", ui->P4Color->currentIndex()).toInt());
+    QJsonObject legacyOutputs;
+    for (const QString &key : settings.childKeys()) {
+        legacyOutputs[key] = key.endsWith("Index") ? QJsonValue(settings.value(key).toInt())
+                                                   : QJsonValue(settings.value(key).toString());
     }
-
-    {
-        QSignalBlocker blockRecoil(ui->Recoil);
-        QSignalBlocker blockRecoilText(ui->Recoil_Text);
-        safeSetIndex(ui->Recoil, settings.value("RecoilIndex", ui->Recoil->currentIndex()).toInt());
-        ui->Recoil_Text->setPlainText(settings.value("RecoilText", ui->Recoil_Text->toPlainText()).toString());
+    settings.endGroup();
+    if (!legacyOutputs.isEmpty()) {
+        profiles.setDefaultProfile(legacyOutputs);
+        if (profiles.flush()) {
+            qCDebug(lcIni) << "Moved the [Outputs] settings into the default profile";
+            settings.remove("Outputs");
+        }
     }
+}
 
-    {
-        QSignalBlocker blockDamage(ui->Damaged);
-        QSignalBlocker blockDamageText(ui->Damaged_Text);
-        safeSetIndex(ui->Damaged, settings.value("DamagedIndex", ui->Damaged->currentIndex()).toInt());
-        ui->Damaged_Text->setPlainText(settings.value("DamagedText", ui->Damaged_Text->toPlainText()).toString());
-    }
+///
+/// The output widgets remembered per game, keyed as in the profile files.
+///
+QList<MainWindow::OutputField> MainWindow::outputFields() const
+{
+    return {
+        {"P1Color", openFire->P1Color, nullptr},
+        {"P2Color", openFire->P2Color, nullptr},
+        {"P3Color", openFire->P3Color, nullptr},
+        {"P4Color", openFire->P4Color, nullptr},
+        {"Recoil", openFire->Recoil, openFire->Recoil_Text},
+        {"Damaged", openFire->Damaged, openFire->Damaged_Text},
+        {"Clip", openFire->Clip, openFire->Clip_Text},
+        {"Ammo", openFire->Ammo, openFire->Ammo_Text},
+        {"Life", openFire->Life, openFire->Life_Text},
+        {"Credits", openFire->Credits, openFire->Credits_Text},
+    };
+}
 
-    {
-        QSignalBlocker blockClip(ui->Clip);
-        QSignalBlocker blockClipText(ui->Clip_Text);
-        safeSetIndex(ui->Clip, settings.value("ClipIndex", ui->Clip->currentIndex()).toInt());
-        ui->Clip_Text->setPlainText(settings.value("ClipText", ui->Clip_Text->toPlainText()).toString());
+QJsonObject MainWindow::outputProfile() const
+{
+    QJsonObject profile;
+    for (const OutputField &field : outputFields()) {
+        profile[QString(field.key) + "Index"] = field.combo->currentIndex();
+        if (field.text)
+            profile[QString(field.key) + "Text"] = field.text->toPlainText();
     }
+    return profile;
+}
 
-    {
-        QSignalBlocker blockAmmo(ui->Ammo);
-        QSignalBlocker blockAmmoText(ui->Ammo_Text);
-        safeSetIndex(ui->Ammo, settings.value("AmmoIndex", ui->Ammo->currentIndex()).toInt());
-        ui->Ammo_Text->setPlainText(settings.value("AmmoText", ui->Ammo_Text->toPlainText()).toString());
-    }
+///
+/// Re-applies a game's saved output choices on top of its freshly loaded ini.
+/// Runs inside applyOpenFireSettings() with the tab's signals blocked: LED
+/// colours are written into originalIniContent here and the caller
+/// regenerates the rest of the ini once.
+///
+void MainWindow::restoreOutputProfile(const QJsonObject &profile)
+{
+    if (profile.isEmpty())
+        return;
 
-    {
-        QSignalBlocker blockLife(ui->Life);
-        QSignalBlocker blockLifeText(ui->Life_Text);
-        safeSetIndex(ui->Life, settings.value("LifeIndex", ui->Life->currentIndex()).toInt());
-        ui->Life_Text->setPlainText(settings.value("LifeText", ui->Life_Text->toPlainText()).toString());
-    }
+    const QComboBox *playerColors[] = {openFire->P1Color, openFire->P2Color, openFire->P3Color, openFire->P4Color};
+    for (const OutputField &field : outputFields()) {
+        // Players and outputs the ini does not have stay as loaded
+        if (!field.combo->isEnabled() || field.combo->isHidden())
+            continue;
+
+        const int index = profile.value(QString(field.key) + "Index").toInt(-1);
+        if (index >= 0 && index < field.combo->count() && index != field.combo->currentIndex()) {
+            qCDebug(lcIni) << "Profile" << profileRom << "overrides" << field.key << "from the ini";
+            field.combo->setCurrentIndex(index);
+            for (int player = 1; player <= 4; ++player) {
+                if (field.combo != playerColors[player - 1])
+                    continue;
+                // "X" (index 0) clears the player's LmpStart value
+                LedColor led;
+                if (index != 0) {
+                    const QColor color = field.combo->itemData(index).value<QColor>();
+                    led.red = color.red();
+                    led.green = color.green();
+                    led.blue = color.blue();
+                }
+                originalIniContent = OpenFireConfig::setLmpStart(originalIniContent, player, led);
+            }
+        }
 
-    {
-        QSignalBlocker blockCredits(ui->Credits);
-        QSignalBlocker blockCreditsText(ui->Credits_Text);
-        safeSetIndex(ui->Credits, settings.value("CreditsIndex", ui->Credits->currentIndex()).toInt());
-        ui->Credits_Text->setPlainText(settings.value("CreditsText", ui->Credits_Text->toPlainText()).toString());
+        const QJsonValue text = profile.value(QString(field.key) + "Text");
+        if (field.text && text.isString() && field.text->toPlainText() != text.toString()) {
+            qCDebug(lcIni) << "Profile" << profileRom << "overrides" << field.key << "text from the ini";
+            field.text->setPlainText(text.toString());
+        }
     }
+}
 
-    settings.endGroup();
+///
+/// Captures the current game's output choices into its profile, when the
+/// user edited them, and writes whatever changed. Runs from the debounce
+/// timer, before switching games and on exit.
+///
+void MainWindow::saveOutputProfile()
+{
+    profileSaveTimer->stop();
+    if (profileDirty && openFire && !profileRom.isEmpty())
+        profiles.setProfile(profileRom, outputProfile());
+    profileDirty = false;
+    profiles.flush();
 }
 
 void MainWindow::saveSettings() {
-    const QString settingsPath = QDir(QCoreApplication::applicationDirPath()).filePath("settings.ini");
+    DSQ_TRACE_SPAN("MainWindow::saveSettings");
     QSettings settings(settingsPath, QSettings::IniFormat);
 
     settings.beginGroup("Paths");
@@ -2168,32 +2054,60 @@ void MainWindow::saveSettings() {
     settings.setValue("DemulShooterArgs", ui->demulShooterArgsLineEdit->text());
     settings.endGroup();
 
-    settings.beginGroup("Outputs");
-    settings.setValue("P1ColorIndex", ui->P1Color->currentIndex());
-    settings.setValue("P2ColorIndex", ui->P2Color->currentIndex());
-    settings.setValue("P3ColorIndex", ui->P3Color->currentIndex());
-    settings.setValue("P4ColorIndex", ui->P4Color->currentIndex());
-
-    settings.setValue("RecoilIndex", ui->Recoil->currentIndex());
-    settings.setValue("RecoilText", ui->Recoil_Text->toPlainText());
+    settings.beginGroup("Session");
+    settings.setValue("Emulator", ui->emulatorComboBox->currentText());
+    settings.setValue("Game", ui->romComboBox->currentText());
+    settings.setValue("Tab", ui->tabWidget_Advanced->currentIndex());
+    settings.setValue("EditorCursor", ui->plainTextEdit_Generic->textCursor().position());
+    settings.setValue("EditorScroll", ui->plainTextEdit_Generic->verticalScrollBar()->value());
+    settings.endGroup();
 
-    settings.setValue("DamagedIndex", ui->Damaged->currentIndex());
-    settings.setValue("DamagedText", ui->Damaged_Text->toPlainText());
+    settings.sync();
+}
 
-    settings.setValue("ClipIndex", ui->Clip->currentIndex());
-    settings.setValue("ClipText", ui->Clip_Text->toPlainText());
+///
+/// Puts the window back where the last session left it: emulator, game,
+/// tab and editor position. Only the restored game's ini and bat are read;
+/// the emulator's own defaults and the first game in the list are skipped.
+///
+void MainWindow::restoreSession() {
+    DSQ_TRACE_SPAN("MainWindow::restoreSession");
+    QSettings settings(settingsPath, QSettings::IniFormat);
+    settings.beginGroup("Session");
+    const QString emulator = settings.value("Emulator").toString();
+    const QString game = settings.value("Game").toString();
+    const int tab = settings.value("Tab", -1).toInt();
+    const int cursorPosition = settings.value("EditorCursor", 0).toInt();
+    const int scrollPosition = settings.value("EditorScroll", 0).toInt();
+    settings.endGroup();
 
-    settings.setValue("AmmoIndex", ui->Ammo->currentIndex());
-    settings.setValue("AmmoText", ui->Ammo_Text->toPlainText());
+    if (ui->emulatorComboBox->findText(emulator) >= 0 && emulator != ui->emulatorComboBox->currentText()) {
+        // Paths were already restored; don't let the emulator reset them
+        {
+            const QSignalBlocker blockEmulator(ui->emulatorComboBox);
+            ui->emulatorComboBox->setCurrentText(emulator);
+        }
+        updateGamesList();
+    }
 
-    settings.setValue("LifeIndex", ui->Life->currentIndex());
-    settings.setValue("LifeText", ui->Life_Text->toPlainText());
+    if (!game.isEmpty() && ui->romComboBox->findText(game) >= 0) {
+        {
+            const QSignalBlocker blockGame(ui->romComboBox);
+            ui->romComboBox->setCurrentText(game);
+        }
+        loadIniSettings(game);
 
-    settings.setValue("CreditsIndex", ui->Credits->currentIndex());
-    settings.setValue("CreditsText", ui->Credits_Text->toPlainText());
-    settings.endGroup();
+        QTextCursor cursor = ui->plainTextEdit_Generic->textCursor();
+        cursor.setPosition(qBound(0, cursorPosition, ui->plainTextEdit_Generic->document()->characterCount() - 1));
+        ui->plainTextEdit_Generic->setTextCursor(cursor);
+        // The scroll range is only known once the editor has laid out the text
+        QTimer::singleShot(0, this, [this, scrollPosition]() {
+            ui->plainTextEdit_Generic->verticalScrollBar()->setValue(scrollPosition);
+        });
+    }
 
-    settings.sync();
+    if (tab >= 0 && tab < ui->tabWidget_Advanced->count())
+        ui->tabWidget_Advanced->setCurrentIndex(tab);
 }
 
 // Add this new function after initializeUI
@@ -2252,19 +2166,36 @@ void MainWindow::showTextEditorContextMenu(const QPoint &pos)
 // Add the launchGame implementation at the end of the file
 void MainWindow::launchGame()
 {
-    // First export the files
-    if (!exportFiles(false)) {
+    DSQ_TRACE_SPAN("MainWindow::launchGame");
+    // Get the current ROM name and create the BAT file path
+    QString rom = ui->romComboBox->currentText();
+    QString rom2 = EmulatorUtils::mapRom(rom);
+    QString qmamehookerPath = ui->qmamehookerPathLineEdit->text();
+    QString iniFilePath, batFilePath;
+    exportFilePaths(qmamehookerPath, rom, iniFilePath, batFilePath);
+    prepareIniForExport();
+
+    // Export first, unless the files on disk already hold exactly this content
+    ExportCache exportCache(settingsPath);
+    const QByteArray fingerprint = ExportCache::fingerprint(iniFilePath, batFilePath,
+                                                            ui->plainTextEdit_Generic->toPlainText(),
+                                                            ui->plainTextEdit_Bat->toPlainText());
+    if (exportCache.isCurrent(rom2, fingerprint, iniFilePath, batFilePath)) {
+        qCDebug(lcLaunch) << "Exported files are up to date; skipping export for" << rom2;
+    } else if (!writeExportFiles(false)) {
         QMessageBox::warning(this, "Export Error",
                              "Failed to export files; game launch aborted.");
-        qWarning() << "Export failed; game launch aborted.";
+        qCWarning(lcLaunch) << "Export failed; game launch aborted.";
         return;
     }
 
-    // Get the current ROM name and create the BAT file path
-    QString rom = ui->romComboBox->currentText();
-    QString rom2 = EmulatorUtils::mapRom(rom);
-    QString qmamehookerPath = ui->qmamehookerPathLineEdit->text();
-    QString batFilePath = qmamehookerPath + "/bat/" + rom + ".bat";
+    // With verbose on, run QMamehook ourselves so its output lands in the log pane
+    QString launchBatPath = batFilePath;
+    if (ui->verboseComboBox->currentText() == "Yes") {
+        QString remainingBatPath;
+        if (startHookerWithCapture(batFilePath, remainingBatPath))
+            launchBatPath = remainingBatPath;
+    }
 
     // Launch the BAT file
     QProcess *process = new QProcess(this);
@@ -2272,11 +2203,11 @@ void MainWindow::launchGame()
     
     #ifdef Q_OS_WIN
     // On Windows, use cmd.exe to run the batch file
-    process->start("cmd.exe", QStringList() << "/c" << QDir::toNativeSeparators(batFilePath));
+    process->start("cmd.exe", QStringList() << "/c" << QDir::toNativeSeparators(launchBatPath));
     #else
     // On other platforms, make the file executable and run it directly
-    QFile::setPermissions(batFilePath, QFile::permissions(batFilePath) | QFile::ExeUser);
-    process->start("/bin/sh", QStringList() << QDir::toNativeSeparators(batFilePath));
+    QFile::setPermissions(launchBatPath, QFile::permissions(launchBatPath) | QFile::ExeUser);
+    process->start("/bin/sh", QStringList() << QDir::toNativeSeparators(launchBatPath));
     #endif
 
     // Connect the finished signal to clean up the process
@@ -2289,3 +2220,72 @@ void MainWindow::launchGame()
                            QString("Failed to launch the game: %1").arg(error));
     });
 }
+
+///
+/// Starts the bat's QMamehook line detached, as the bat's own "start" would, so it
+/// keeps running after DemulEASY closes. Its output goes to QMamehook.log next to
+/// the settings file, which the log pane follows. The rest of the bat is written to
+/// a temporary file to run instead. Returns false, with no QMamehook started, when
+/// the bat has no Hooker line, the script or log cannot be written or QMamehook does
+/// not start; the caller then runs the whole bat.
+///
+bool MainWindow::startHookerWithCapture(const QString &batFilePath, QString &remainingBatPath)
+{
+    QString batText;
+    TextFormat batFormat;
+    if (!TextFile::read(batFilePath, batText, &batFormat))
+        return false;
+
+    // start /MIN "Hooker" "<QMamehook.exe>" -p "<ini dir>" -v -c
+    static const QString hookerTitle = "\"Hooker\"";
+    QStringList hookerCommand;
+    QStringList remainingLines;
+    for (const QString &line : batText.split('\n')) {
+        const int titlePos = line.indexOf(hookerTitle);
+        if (hookerCommand.isEmpty() && titlePos >= 0 && line.trimmed().startsWith("start", Qt::CaseInsensitive))
+            hookerCommand = QProcess::splitCommand(line.mid(titlePos + hookerTitle.length()).trimmed());
+        else
+            remainingLines.append(line);
+    }
+    if (hookerCommand.isEmpty())
+        return false;
+
+    // Write the script before starting anything, so a failure leaves nothing running
+    auto *script = new QTemporaryFile(QDir::temp().filePath("DemulEASY-launch-XXXXXX.bat"), this);
+    if (!script->open() || script->write(TextFile::encode(remainingLines.join('\n'), batFormat)) < 0
+        || !script->flush()) {
+        qCWarning(lcLaunch) << "Failed to write launch script:" << script->fileName();
+        delete script;
+        return false;
+    }
+    script->close();
+
+    // Both channels append to the emptied log so their lines interleave
+    const QString logPath = QFileInfo(settingsPath).dir().filePath("QMamehook.log");
+    QFile log(logPath);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(lcLaunch) << "Failed to write QMamehook log:" << logPath;
+        delete script;
+        return false;
+    }
+    log.close();
+
+    QProcess hooker;
+    hooker.setProgram(hookerCommand.takeFirst());
+    hooker.setArguments(hookerCommand);
+    hooker.setStandardOutputFile(logPath, QIODevice::Append);
+    hooker.setStandardErrorFile(logPath, QIODevice::Append);
+    hookLog->appendLine(QString("-- Starting %1 %2 --").arg(hooker.program(), hookerCommand.join(' ')));
+    if (!hooker.startDetached()) {
+        qCWarning(lcLaunch) << "QMamehook did not start:" << hooker.errorString();
+        hookLog->appendLine(QString("-- QMamehook did not start: %1 --").arg(hooker.errorString()));
+        delete script;
+        return false;
+    }
+    hookLog->follow(logPath);
+    // The previous launch's script has long been read by its cmd.exe
+    delete launchScript;
+    launchScript = script;
+    remainingBatPath = script->fileName();
+    return true;
+}
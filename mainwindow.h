@@ -3,11 +3,31 @@
 
 #include <QMainWindow>
 #include <QDir>
-#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QColor>
+#include <QHash>
+#include <array>
+#include "commandvalidator.h"
 #include "emulatorutils.h"
+#include "inihistory.h"
+#include "iniindex.h"
+#include "openfireconfig.h"
+#include "openfireflags.h"
+#include "profilestore.h"
+
+class HookLogPane;
+class QComboBox;
+class QFileSystemWatcher;
+class QPlainTextEdit;
+class QTableWidget;
+class QTemporaryFile;
+class QTextEdit;
+class QTimer;
 
 namespace Ui {
 class MainWindow;
+class OpenFireTab;
 }
 
 class MainWindow : public QMainWindow
@@ -15,9 +35,28 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = nullptr);
+    // settingsPath defaults to settings.ini next to the executable.
+    explicit MainWindow(QWidget *parent = nullptr, const QString &settingsPath = QString());
     ~MainWindow();
 
+    // How often the expensive refresh paths ran; read by the UI latency harness.
+    struct CallCounters
+    {
+        int updateIniText = 0;
+        int iniRegenerations = 0; // updateIniText calls that rewrote the ini
+        int loadIniSettings = 0;
+        int setPlainText = 0;
+    };
+    const CallCounters &callCounters() const { return counters; }
+    void resetCallCounters() { counters = CallCounters(); }
+
+    // Finishes the startup work deferred until after the first paint. Safe to
+    // call more than once; the latency harness calls it instead of waiting.
+    void completeStartup();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     bool exportFiles(bool showMessage = true);
     void updateGamesList();
@@ -32,25 +71,60 @@ private slots:
     void refreshIni();
     void showTextEditorContextMenu(const QPoint &pos);
     void launchGame();
+    void toggleTrace();
+    void applyToAllGames();
+    void undoIniChange();
+    void redoIniChange();
 
 private:
     Ui::MainWindow *ui;
+    Ui::OpenFireTab *openFire = nullptr; // built on first view, see ensureOpenFireTab()
+    HookLogPane *hookLog = nullptr;     // captured QMamehook output
+    QTemporaryFile *launchScript = nullptr; // the rest of that launch's bat
+    QTableWidget *overviewTable = nullptr; // one row per ini, from iniIndex
+    QPlainTextEdit *exportPreview = nullptr; // diff of what Export would write
+
+    QString settingsPath;
+    CallCounters counters;
+
+    // Per-game output choices; profileRom is the game the OpenFIRE tab shows.
+    static const int profileSaveDelayMs = 500;
+    ProfileStore profiles;
+    QTimer *profileSaveTimer = nullptr;
+    QString profileRom;
+    bool profileDirty = false; // the user changed an output since the last save
+    struct OutputField
+    {
+        const char *key;
+        QComboBox *combo;
+        QTextEdit *text; // null for the LED colour combos
+    };
+    QList<OutputField> outputFields() const;
+    QJsonObject outputProfile() const;
+    void restoreOutputProfile(const QJsonObject &profile);
+    void saveOutputProfile();
+
+    // Startup phases are timed from the start of the constructor.
+    QElapsedTimer startupTimer;
+    qint64 lastStartupPhaseNs = 0;
+    bool firstPaintSeen = false;
+    bool startupComplete = false;
+    void markStartupPhase(const char *phase);
 
     QString originalIniContent; // Stores the original structure of loaded INI files
     bool isLoadingIni = false; // Flag to indicate we're in the process of loading an INI file
     bool hasLoadedIni = false; // Flag to indicate if we're working with a loaded INI file
-    static const QRegularExpression recoilRegex;
-    static const QRegularExpression damageRegex;
-    static const QRegularExpression clipRegex;
-    static const QRegularExpression ammoRegex;
-    static const QRegularExpression lifeRegex;
-    static const QRegularExpression creditsRegex;
+
+    // Setting changes made through the OpenFIRE tab, undone/redone as line patches
+    IniHistory iniHistory;
+    bool applyingHistory = false;
+    void applyHistoryText();
 
     // Helper methods to reduce duplicate code.
     void prepareDirectories(const QString &basePath, QDir &iniDir, QDir &batDir);
     void mapEmulator(QString &emulator, QString &demulShooterExe);
     QString mapRom(const QString &rom);
-      void createFiles(const QString &rom,
+      bool createFiles(const QString &rom,
                        const QString &emulatorInput,
                        QString demulShooterExeInput,
                        const QString &emulatorPath,
@@ -69,8 +143,33 @@ private:
                                  const QString &demulShooterPath,
                                  const QString &verbose,
                                  const QString &demulShooterArgs);
+    void exportFilePaths(const QString &qmamehookerPath, const QString &rom,
+                         QString &iniFilePath, QString &batFilePath) const;
     void updateLmpStartValue(int player, const QColor &color);
-    bool safeReplaceLine(QStringList &lines, const QString &key, const QString &newLine);
+
+    // Where each player's LmpStart line was last seen, in originalIniContent
+    // and as an editor block, so a colour change rewrites just that line.
+    // Checked before use and looked up again when the text has moved.
+    struct LmpStartLine
+    {
+        qsizetype offset = -1;
+        qsizetype length = 0;
+        int block = -1;
+    };
+    std::array<LmpStartLine, 4> lmpStartLines;
+    QHash<QRgb, int> ledColorIndex; // colour combo index by RGB
+    bool replaceLmpStartLine(int player, const QString &line);
+    void setOutputForAllPlayers(const QString &key, const QString &value);
+    void setIniEditorText(const QString &text);
+
+    // OpenFIRE tab <-> OpenFireSettings
+    void ensureOpenFireTab();
+    void prepareIniForExport();
+    bool writeExportFiles(bool showMessage);
+    void applyOpenFireSettings(const QString &iniContent, const QJsonObject &profile = QJsonObject(),
+                               bool regenerate = true);
+    OpenFireSettings readOpenFireSettings() const;
+    QList<QPair<const OpenFireFlags::Family *, QComboBox *>> flagCombos() const;
 
     // New UI initialization helper methods.
     void initializeUI();
@@ -80,14 +179,67 @@ private:
     void setupColorComboBoxes();
     void setupSignalConnections();
     void setupDefaultIni();
+    void setupOpenFireFields();
+    void setupOpenFireConnections();
+    void resetOpenFireFields();
 
     // New helper function to ensure comboboxes are properly set
     void updateAllComboBoxes();
     void updateBatCommandLine();
 
+    // Launch helpers
+    bool startHookerWithCapture(const QString &batFilePath, QString &remainingBatPath);
+
     // Settings persistence helpers
     void loadSettings();
     void saveSettings();
+    void restoreSession();
+
+    // Ini folder index, refreshed on indexPool and shown in the Overview tab
+    IniIndex iniIndex;
+    QThreadPool indexPool;
+    bool indexRefreshRunning = false;
+    void refreshIniIndex();
+    void showIniIndex();
+
+    // Command checking for the ini editor. validator is only used by the
+    // single validationPool thread; results for outdated text are dropped.
+    static const int validationDelayMs = 150;
+    CommandValidator validator;
+    QThreadPool validationPool;
+    QTimer *validationTimer = nullptr;
+    bool validationRunning = false;
+    bool validationPending = false;
+    QList<CommandValidator::Problem> iniProblems;
+    void startValidation();
+    void showValidation(const QList<CommandValidator::Problem> &problems);
+    void showProblemAtCursor();
+
+    // Export preview, refreshed shortly after an edit while its tab is open
+    static const int exportPreviewDelayMs = 150;
+    QTimer *exportPreviewTimer = nullptr;
+    void refreshExportPreview();
+    static QString describeExportChange(const QString &path, const QString &content, bool withDiff);
+
+    // External edits to the loaded ini/bat. disk*Content is the file as last
+    // loaded or exported; *EditorBaseline is the editor text at that point,
+    // so a difference means unsaved local edits.
+    static const int fileChangeDelayMs = 200;
+    QFileSystemWatcher *fileWatcher = nullptr;
+    QTimer *fileChangeTimer = nullptr;
+    QSet<QString> pendingFileChanges;
+    QString watchedIniPath;
+    QString watchedBatPath;
+    QString diskIniContent;
+    QString diskBatContent;
+    QString iniEditorBaseline;
+    QString batEditorBaseline;
+    void watchLoadedFiles(const QString &iniPath, const QString &batPath);
+    static QString readTextFile(const QString &path);
+    void reloadChangedFiles();
+    bool confirmReload(const QString &path);
+    void reloadIniFromDisk();
+    void reloadBatFromDisk();
 };
 
 #endif // MAINWINDOW_H
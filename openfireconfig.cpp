@@ -0,0 +1,573 @@
+#include "openfireconfig.h"
+#include "inidocument.h"
+#include "openfireflags.h"
+#include "textfile.h"
+#include <QRegularExpression>
+#include <algorithm>
+
+QStringList OpenFireSettings::modeFlags() const
+{
+    QStringList flags;
+    for (const OpenFireFlags::Family *family : OpenFireFlags::modes()) {
+        if (!(this->*family->field).isEmpty())
+            flags << this->*family->field;
+    }
+    return flags;
+}
+
+bool OpenFireSettings::hasOutput(const QString &key) const
+{
+    for (const auto &output : outputs) {
+        if (output.first == key)
+            return true;
+    }
+    return false;
+}
+
+QString OpenFireSettings::outputValue(const QString &key) const
+{
+    for (const auto &output : outputs) {
+        if (output.first == key)
+            return output.second;
+    }
+    return QString();
+}
+
+// The scanners below replace regular expressions that could backtrack on
+// long or malformed lines; each makes a single forward pass.
+
+static int skipSpaces(const QString &text, int i)
+{
+    while (i < text.size() && text.at(i).isSpace())
+        ++i;
+    return i;
+}
+
+static int skipBlanks(QStringView text, int i)
+{
+    while (i < text.size() && (text.at(i) == ' ' || text.at(i) == '\t'))
+        ++i;
+    return i;
+}
+
+static int skipDigits(const QString &text, int i)
+{
+    while (i < text.size() && text.at(i).isDigit())
+        ++i;
+    return i;
+}
+
+static int lineEndFrom(const QString &text, int from)
+{
+    const int end = text.indexOf('\n', from);
+    return end < 0 ? text.size() : end;
+}
+
+// Calls visit(valueStart, lineEnd) for the first "MameStart[ \t]*=" on each
+// line until it returns true. The '=' must be on the same line as the key.
+// The search resumes at the end of a visited line, so a line repeating the
+// key is only read once.
+template <typename Visitor>
+static void forEachMameStart(const QString &text, Visitor visit)
+{
+    int from = 0;
+    int pos;
+    while ((pos = text.indexOf(QLatin1String("MameStart"), from)) >= 0) {
+        from = pos + 9;
+        const int eq = skipBlanks(text, from);
+        if (eq >= text.size() || text.at(eq) != '=')
+            continue;
+        const int lineEnd = lineEndFrom(text, eq + 1);
+        if (visit(eq + 1, lineEnd))
+            return;
+        from = lineEnd;
+    }
+}
+
+// Matches "cmw\s+<digits>\s+" at pos; returns the index after it or -1.
+// number receives the digits.
+static int matchCmw(const QString &text, int pos, int *number = nullptr)
+{
+    if (!QStringView(text).mid(pos, 3).startsWith(QLatin1String("cmw")))
+        return -1;
+    int i = skipSpaces(text, pos + 3);
+    if (i == pos + 3)
+        return -1;
+    const int digits = i;
+    i = skipDigits(text, digits);
+    if (i == digits)
+        return -1;
+    if (number)
+        *number = text.mid(digits, i - digits).toInt();
+    return i;
+}
+
+// The compact flag word ("S6xM0x1xM3x1") of the first "cmw N S<digits>" on a MameStart line.
+static QString mameStartFlags(const QString &text)
+{
+    QString flags;
+    forEachMameStart(text, [&](int valueStart, int lineEnd) {
+        // Stays within the line, so a line without a match never reads on
+        for (int c = valueStart; c + 3 <= lineEnd; ++c) {
+            int i = matchCmw(text, c);
+            if (i < 0)
+                continue;
+            const int s = skipSpaces(text, i);
+            if (s == i || s >= text.size() || text.at(s) != 'S')
+                continue;
+            if (skipDigits(text, s + 1) == s + 1)
+                continue;
+
+            int end = s;
+            while (end < text.size() && text.at(end) != ',' && !text.at(end).isSpace())
+                ++end;
+            flags = text.mid(s, end - s);
+            return true;
+        }
+        return false;
+    });
+    return flags;
+}
+
+// Player numbers from the last "cmw N" on each MameStart line.
+static void collectMameStartPlayers(const QString &text, QSet<int> &players)
+{
+    forEachMameStart(text, [&](int valueStart, int lineEnd) {
+        for (int c = lineEnd - 3; c >= valueStart; --c) {
+            int player = 0;
+            if (matchCmw(text, c, &player) >= 0) {
+                if (player > 0)
+                    players.insert(player);
+                break;
+            }
+        }
+        return false;
+    });
+}
+
+// Player 1 payload of "<key> = cmw 1 <value>" at the start of a line. With
+// allowEmpty, a bare "<key> =" also counts and yields an empty value.
+static bool playerOneValue(const QString &text, const QString &key, bool allowEmpty, QString &value)
+{
+    for (LineReader lines(text); !lines.atEnd(); ) {
+        const QStringView line = lines.next();
+        if (!line.startsWith(key))
+            continue;
+
+        int i = skipBlanks(line, key.size());
+        if (i >= line.size() || line.at(i) != '=')
+            continue;
+        i = skipBlanks(line, i + 1);
+        if (allowEmpty && i == line.size()) {
+            value = QString();
+            return true;
+        }
+        if (!line.mid(i).startsWith(QLatin1String("cmw")))
+            continue;
+        i = skipBlanks(line, i + 3);
+        if (i >= line.size() || line.at(i) != '1')
+            continue;
+        i = skipBlanks(line, i + 1);
+
+        int end = int(line.size());
+        while (end > i && (line.at(end - 1) == ' ' || line.at(end - 1) == '\t'))
+            --end;
+        value = line.mid(i, end - i).toString();
+        return true;
+    }
+    return false;
+}
+
+// Section text from "[name]" up to the next '[' (or the end).
+static QString sectionText(const QString &content, const QString &name)
+{
+    const int pos = content.indexOf('[' + name + ']');
+    if (pos < 0)
+        return QString();
+    int next = content.indexOf('[', pos + 1);
+    if (next < 0) next = content.length();
+    return content.mid(pos, next - pos);
+}
+
+OpenFireSettings OpenFireConfig::parse(const QString &iniContent)
+{
+    OpenFireSettings settings;
+
+    const QString generalSection = sectionText(iniContent, "General");
+    if (!generalSection.isNull()) {
+        // Start and mode flags normally live in MameStart; older files listed
+        // the modes as their own lines in [General].
+        OpenFireFlags::decode(mameStartFlags(generalSection), settings);
+        for (LineReader lines(generalSection); !lines.atEnd(); ) {
+            const QStringView line = lines.next().trimmed();
+            if (OpenFireFlags::isModeFlag(line))
+                OpenFireFlags::decode(line, settings);
+        }
+    }
+
+    // Detect the number of players in the INI file
+    const QString outputSection = sectionText(iniContent, "Output");
+    if (!outputSection.isNull()) {
+        QSet<int> foundPlayers;
+        auto collect = [&foundPlayers](const QString &text, const QRegularExpression &rx) {
+            auto matches = rx.globalMatch(text);
+            while (matches.hasNext()) {
+                bool ok;
+                const int player = matches.next().captured(1).toInt(&ok);
+                if (ok && player > 0)
+                    foundPlayers.insert(player);
+            }
+        };
+
+        // P1_Something, Player1_Something, and the players MameStart talks to
+        static const QRegularExpression playerPattern(R"(P(\d+)(?:_|\s*=|\s+))");
+        static const QRegularExpression player2Pattern(R"(Player\s*(\d+)(?:_|\s*=|\s+))");
+        collect(outputSection, playerPattern);
+        collect(outputSection, player2Pattern);
+        collectMameStartPlayers(iniContent, foundPlayers);
+
+        if (!foundPlayers.isEmpty())
+            settings.playerCount = *std::max_element(foundPlayers.begin(), foundPlayers.end());
+
+        // Find all player-based settings (P1_Something, P2_Something, etc.)
+        static const QRegularExpression settingPattern(R"(P(\d+)_(\w+)\s*=)");
+        auto settingMatches = settingPattern.globalMatch(outputSection);
+        while (settingMatches.hasNext()) {
+            const auto match = settingMatches.next();
+            bool ok;
+            const int player = match.captured(1).toInt(&ok);
+            if (ok && player > 0)
+                settings.presentSettings.insert(match.captured(2));
+        }
+    }
+    settings.playerCount = qMax(1, settings.playerCount);
+
+    // Player 1 payloads for the known outputs
+    const QList<QPair<QString, bool>> outputKeys = {
+        {"CtmRecoil", false}, {"Damaged", false}, {"Clip", false},
+        {"Ammo", true}, {"Life", true}, {"Credits", true}
+    };
+    for (const auto &output : outputKeys) {
+        const QString key = output.first == "Credits" ? output.first : "P1_" + output.first;
+        QString value;
+        if (playerOneValue(iniContent, key, output.second, value))
+            settings.outputs.append(qMakePair(output.first, value.trimmed()));
+    }
+
+    settings.ledColors = lmpStartColors(iniContent);
+
+    return settings;
+}
+
+QString OpenFireConfig::apply(const QString &iniContent, const OpenFireSettings &settings)
+{
+    /*****  small helpers  *****/
+    auto safeReplaceLine = [](QStringList &lines,
+                              const QString  &keyPrefix,
+                              const QString  &newLine) -> bool
+    {
+        for (int i = 0; i < lines.size(); ++i) {
+            if (lines[i].trimmed().startsWith(keyPrefix, Qt::CaseInsensitive)) {
+                lines[i] = newLine;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    /*****  working copy of the whole file  *****/
+    QString updatedContent = iniContent;
+    const int playerCount = settings.playerCount;
+
+    /* -------------------------------------------------------------------- */
+    /* 1.  Update the MameStart line (start flags etc.)                     */
+    /* -------------------------------------------------------------------- */
+    const QString &start = settings.startCommand;
+    if (!start.isEmpty()) {
+        // The first MameStart line, up to (not including) its line break
+        int keyStart = -1;
+        int valueStart = -1;
+        int lineEnd = -1;
+        forEachMameStart(updatedContent, [&](int afterEquals, int end) {
+            keyStart = updatedContent.lastIndexOf(QLatin1String("MameStart"), afterEquals);
+            valueStart = skipBlanks(updatedContent, afterEquals);
+            lineEnd = end > valueStart && updatedContent.at(end - 1) == '\r' ? end - 1 : end;
+            return true;
+        });
+        if (keyStart >= 0) {
+            QString mameStartValue = updatedContent.mid(valueStart, lineEnd - valueStart);
+
+            const QString flags = OpenFireFlags::encode(settings);
+
+            // Split the MameStart value into individual commands
+            QStringList commands = mameStartValue.split(',');
+            QStringList newCommands;
+
+            static const QRegularExpression playerCmdRx(R"(cmw\s+(\d+)\s+(?:S[0-6])?(?:x[^,\s]*)?)");
+            for (const QString &cmd : commands) {
+                QString trimmedCmd = cmd.trimmed();
+
+                // Handle cmw commands (player-specific commands)
+                if (trimmedCmd.startsWith("cmw")) {
+                    auto playerMatch = playerCmdRx.match(trimmedCmd);
+
+                    if (playerMatch.hasMatch()) {
+                        int player = playerMatch.captured(1).toInt();
+                        // Add both start flag and mode flags
+                        newCommands.append(QString("cmw %1 %2").arg(player).arg(flags));
+                    } else {
+                        newCommands.append(trimmedCmd);
+                    }
+                } else if (trimmedCmd.startsWith("\"cmo")) {
+                    // Keep cmo commands with quotes
+                    newCommands.append(trimmedCmd);
+                } else if (trimmedCmd.startsWith("cmo")) {
+                    // Add quotes around cmo commands
+                    newCommands.append(QString("\"%1\"").arg(trimmedCmd));
+                } else {
+                    // Keep other commands unchanged
+                    newCommands.append(trimmedCmd);
+                }
+            }
+
+            // Reconstruct the MameStart line
+            QString newStartValue = newCommands.join(", ");
+            updatedContent.replace(keyStart, lineEnd - keyStart, "MameStart = " + newStartValue);
+        }
+    }
+
+    /* -------------------------------------------------------------------- */
+    /* 2.  Re-write the [General] section without standalone mode flags     */
+    /* -------------------------------------------------------------------- */
+    const int generalPos = updatedContent.indexOf("[General]");
+    if (generalPos >= 0) {
+        int nextPos = updatedContent.indexOf("[", generalPos + 1);
+        if (nextPos < 0) nextPos = updatedContent.length();
+
+        // Drop the mode-flag lines and nothing else, so blank lines and the
+        // whitespace around the section stay as they were
+        const QStringList lines = updatedContent.mid(generalPos, nextPos - generalPos).split('\n');
+        QStringList newLines;
+        for (const QString &line : lines) {
+            if (!OpenFireFlags::isModeFlag(line.trimmed()))
+                newLines.append(line);
+        }
+        if (newLines.size() != lines.size())
+            updatedContent.replace(generalPos, nextPos - generalPos, newLines.join('\n'));
+    }
+
+    /* -------------------------------------------------------------------- */
+    /* 3.  Write Output-section keys (Recoil, Damage, etc.) per player       */
+    /* -------------------------------------------------------------------- */
+    static const QRegularExpression outputHeaderRx(R"(\[Output\])");
+    // Player 1's value is what the OpenFIRE tab shows; while it is unchanged
+    // the other players keep their own values and no missing keys are added.
+    auto isUnchanged = [&iniContent](const QString &key, const QString &value) {
+        QString current;
+        return playerOneValue(iniContent, key, true, current) && current == value;
+    };
+
+    auto writePlayerKey = [&](const QString &settingName,
+                              const QString &value)
+    {
+        if (value.isEmpty() || isUnchanged("P1_" + settingName, value)) return;
+
+        QStringList lines = updatedContent.split('\n');
+
+        for (int player = 1; player <= playerCount; ++player) {
+            const QString key = 'P' + QString::number(player) + '_' + settingName;
+            const QString newLine =
+                QString("%1 = cmw %2 %3").arg(key).arg(player).arg(value);
+
+            if (!safeReplaceLine(lines, key, newLine)) {
+                // key didn't exist – append it just inside [Output]
+                int outPos = lines.indexOf(outputHeaderRx);
+                if (outPos >= 0)
+                    lines.insert(outPos + 1, newLine);
+            }
+        }
+
+        updatedContent = lines.join('\n');
+    };
+
+    for (const auto &output : settings.outputs) {
+        if (output.first != "Credits") {
+            writePlayerKey(output.first, output.second);
+            continue;
+        }
+
+        /* Credits is a single, player-less key */
+        const QString &credits = output.second;
+        if (!credits.isEmpty() && !isUnchanged("Credits", credits)) {
+            QStringList lines = updatedContent.split('\n');
+            if (!safeReplaceLine(lines, "Credits", "Credits = cmw 1 " + credits)) {
+                int outPos = lines.indexOf(outputHeaderRx);
+                if (outPos >= 0)
+                    lines.insert(outPos + 1, "Credits = cmw 1 " + credits);
+            }
+            updatedContent = lines.join('\n');
+        }
+    }
+
+    return updatedContent;
+}
+
+QString OpenFireConfig::setOutputForAllPlayers(const QString &iniContent, const QString &key, const QString &value)
+{
+    IniDocument doc(iniContent);
+
+    if (key == "Credits") {
+        doc.replaceLineStartingWith("Credits", value.isEmpty() ? QString("Credits =")
+                                                               : QString("Credits = cmw 1 %1").arg(value));
+        return doc.serialize();
+    }
+
+    for (int i = 0; i < doc.lineCount(); ++i) {
+        const QString &line = doc.line(i);
+        for (int player = 1; player <= 4; ++player) {
+            const QString prefix = 'P' + QString::number(player);
+            if (!line.startsWith(prefix + '_' + key))
+                continue;
+            if (value.isEmpty())
+                doc.setLine(i, QString("%1_%2 =").arg(prefix, key));
+            else
+                doc.setLine(i, QString("%1_%2 = cmw %3 %4").arg(prefix, key).arg(player).arg(value));
+            break;
+        }
+    }
+    return doc.serialize();
+}
+
+QString OpenFireConfig::lmpStartLine(int player, const LedColor &color)
+{
+    const QString key = QString("P%1_LmpStart").arg(player);
+    if (!color.isValid())
+        return QString("%1 =").arg(key);
+
+    // Format: cmw <player> F2x1x<red>xF3x1x<green>xF4x1x<blue> | cmw <player> F2x1x0xF3x1x0xF4x1x0
+    const QString value = QString("cmw %1 F2x1x%2xF3x1x%3xF4x1x%4 | cmw %1 F2x1x0xF3x1x0xF4x1x0")
+        .arg(player)
+        .arg(color.red)
+        .arg(color.green)
+        .arg(color.blue);
+    return QString("%1 = %2").arg(key, value);
+}
+
+QString OpenFireConfig::setLmpStart(const QString &iniContent, int player, const LedColor &color)
+{
+    IniDocument doc(iniContent);
+    const QString key = QString("P%1_LmpStart").arg(player);
+    const QString newLine = lmpStartLine(player, color);
+
+    // Clearing only touches an existing line
+    if (doc.replaceLineStartingWith(key, newLine) || !color.isValid())
+        return doc.serialize();
+
+    // A new line goes after the last entry of [Output], which is added at
+    // the end of the file when missing
+    int begin, end;
+    if (!doc.sectionRange("Output", begin, end)) {
+        end = doc.lineCount();
+        // Keep the final line break after the new section
+        if (end > 0 && doc.line(end - 1).isEmpty())
+            --end;
+        if (end > 0 && !doc.line(end - 1).trimmed().isEmpty())
+            doc.insertLine(end++, QString());
+        doc.insertLine(end++, "[Output]");
+        begin = end;
+    }
+    while (end > begin && doc.line(end - 1).trimmed().isEmpty())
+        --end;
+    doc.insertLine(end, newLine);
+    return doc.serialize();
+}
+
+// Digits at text[i...]; advances i. -1 when there are none.
+static int scanNumber(QStringView text, int &i)
+{
+    const int start = i;
+    qint64 value = 0;
+    while (i < text.size() && text.at(i).isDigit()) {
+        if (value <= 1000000000)
+            value = value * 10 + text.at(i).digitValue();
+        ++i;
+    }
+    if (i == start)
+        return -1;
+    return value > 1000000000 ? 0 : int(value);
+}
+
+// Consumes literal at text[i...]; false (i unchanged) when it is not there.
+static bool scanLiteral(QStringView text, int &i, QLatin1String literal)
+{
+    if (!text.mid(i).startsWith(literal))
+        return false;
+    i += int(literal.size());
+    return true;
+}
+
+LedColor OpenFireConfig::parseLmpStartLine(QStringView line, int &player)
+{
+    // P<n>_LmpStart = cmw <n> F2x1x<r>xF3x1x<g>xF4x1x<b>
+    LedColor color;
+    int i = skipBlanks(line, 0);
+    if (!scanLiteral(line, i, QLatin1String("P")))
+        return color;
+    const int keyPlayer = scanNumber(line, i);
+    if (keyPlayer < 1 || !scanLiteral(line, i, QLatin1String("_LmpStart")))
+        return color;
+    i = skipBlanks(line, i);
+    if (!scanLiteral(line, i, QLatin1String("=")))
+        return color;
+    i = skipBlanks(line, i);
+    if (!scanLiteral(line, i, QLatin1String("cmw")))
+        return color;
+    int afterBlanks = skipBlanks(line, i);
+    if (afterBlanks == i)
+        return color;
+    i = afterBlanks;
+    if (scanNumber(line, i) != keyPlayer)
+        return color;
+    afterBlanks = skipBlanks(line, i);
+    if (afterBlanks == i)
+        return color;
+    i = afterBlanks;
+
+    int rgb[3];
+    static const char *const channels[] = {"F2x1x", "xF3x1x", "xF4x1x"};
+    for (int c = 0; c < 3; ++c) {
+        if (!scanLiteral(line, i, QLatin1String(channels[c])))
+            return color;
+        rgb[c] = scanNumber(line, i);
+        if (rgb[c] < 0)
+            return color;
+    }
+    player = keyPlayer;
+    color.red = rgb[0];
+    color.green = rgb[1];
+    color.blue = rgb[2];
+    return color;
+}
+
+std::array<LedColor, 4> OpenFireConfig::lmpStartColors(const QString &iniContent)
+{
+    // One pass; the first well-formed line for each player wins
+    std::array<LedColor, 4> colors;
+    for (LineReader lines(iniContent); !lines.atEnd(); ) {
+        const QStringView line = lines.next();
+        if (!line.contains(QLatin1String("_LmpStart")))
+            continue;
+        int player = 0;
+        const LedColor color = parseLmpStartLine(line, player);
+        if (color.isValid() && player <= 4 && !colors[player - 1].isValid())
+            colors[player - 1] = color;
+    }
+    return colors;
+}
+
+LedColor OpenFireConfig::lmpStartColor(const QString &iniContent, int player)
+{
+    if (player < 1 || player > 4)
+        return LedColor();
+    return lmpStartColors(iniContent)[player - 1];
+}
@@ -0,0 +1,79 @@
+#ifndef OPENFIRECONFIG_H
+#define OPENFIRECONFIG_H
+
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <array>
+
+// RGB triple for a P<n>_LmpStart command; red < 0 means "not set".
+struct LedColor
+{
+    int red = -1;
+    int green = 0;
+    int blue = 0;
+
+    bool isValid() const { return red >= 0; }
+};
+
+// Everything the OpenFIRE tab edits, independent of any widget.
+struct OpenFireSettings
+{
+    QString startCommand;   // "S0".."S6"; empty leaves MameStart alone
+    QString deviceMode;     // "M0x1", "M0x1L", ... (empty = not set)
+    QString offscreenMode;  // "M1x2"
+    QString pedalMode;      // "M2x1"
+    QString aspectMode;     // "M3x1"
+    QString rumbleMode;     // "M6x1"
+    QString autoFireMode;   // "M8x1"
+    QString displayMode;    // "MDx3B"
+
+    int playerCount = 1;
+
+    // Output values in write order, keyed by setting name ("CtmRecoil", "Damaged",
+    // "Clip", "Ammo", "Life", "Credits" or a custom key). When parsed, these are
+    // the player 1 payloads after "cmw 1".
+    QList<QPair<QString, QString>> outputs;
+
+    // Output settings present for at least one player in [Output].
+    QSet<QString> presentSettings;
+
+    std::array<LedColor, 4> ledColors;
+
+    QStringList modeFlags() const;
+    bool hasOutput(const QString &key) const;
+    QString outputValue(const QString &key) const;
+};
+
+// Pure ini <-> OpenFireSettings conversions used by the GUI, the CLI and tools.
+class OpenFireConfig
+{
+public:
+    static OpenFireSettings parse(const QString &iniContent);
+
+    // Rewrites MameStart flags and output keys from settings, preserving everything else.
+    // An output is written to every player only when its value differs from
+    // player 1's in iniContent; otherwise each player keeps its own line.
+    static QString apply(const QString &iniContent, const OpenFireSettings &settings);
+
+    // Sets "P<n>_<key> = cmw <n> <value>" on every existing line for the key
+    // (or clears it to "P<n>_<key> =" when value is empty). "Credits" is global.
+    static QString setOutputForAllPlayers(const QString &iniContent, const QString &key, const QString &value);
+
+    // Writes (or clears, when color is invalid) P<n>_LmpStart. A new line is
+    // added at the end of [Output], creating the section when needed.
+    static QString setLmpStart(const QString &iniContent, int player, const LedColor &color);
+    // The whole P<n>_LmpStart line setLmpStart() writes.
+    static QString lmpStartLine(int player, const LedColor &color);
+    static LedColor lmpStartColor(const QString &iniContent, int player);
+    // All four players' colours in one pass over the ini.
+    static std::array<LedColor, 4> lmpStartColors(const QString &iniContent);
+    // Colour of one "P<n>_LmpStart = cmw <n> F2x1x<r>xF3x1x<g>xF4x1x<b>..."
+    // line (sets player), or an invalid colour for any other line.
+    static LedColor parseLmpStartLine(QStringView line, int &player);
+};
+
+#endif // OPENFIRECONFIG_H
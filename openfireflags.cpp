@@ -0,0 +1,166 @@
+#include "openfireflags.h"
+#include <QHash>
+
+const QList<OpenFireFlags::Family> &OpenFireFlags::families()
+{
+    static const QList<Family> table = {
+        {"S", "start", &OpenFireSettings::startCommand, "S6", {
+            {"S0", "Start with solenoid enabled"},
+            {"S1", "Start with rumble enabled"},
+            {"S2", "Start with the RED LED enabled"},
+            {"S3", "Start with the GREEN LED enabled"},
+            {"S4", "Start with the BLUE LED enabled"},
+            {"S6", "Start with everything enabled"},
+        }},
+        {"M0x", "device", &OpenFireSettings::deviceMode, nullptr, {
+            {"M0x0", "Mouse & Keyboard"},
+            {"M0x1", "Gamepad, w/ Camera mapped to Right Stick"},
+            {"M0x1L", "Maps Camera to Left Stick instead (OpenFIRE exclusive)"},
+            {"M0x2", "'Hybrid'"},
+        }},
+        {"M1x", "offscreen", &OpenFireSettings::offscreenMode, nullptr, {
+            {"M1x0", "Disabled (not used in OpenFIRE)", false},
+            {"M1x1", "Fire in bottom-left corner (not used in OpenFIRE)", false},
+            {"M1x2", "Offscreen Button Mode enabled (i.e. offscreen trigger pulls generates a Right Click instead of a Left Click)"},
+            {"M1x3", "Normal shot (always on when Offscreen Button Mode isn't set in OpenFIRE)"},
+        }},
+        {"M2x", "pedal", &OpenFireSettings::pedalMode, nullptr, {
+            {"M2x0", "Separate Button (as mapped)"},
+            {"M2x1", "As Right Mouse"},
+            {"M2x2", "As Middle Mouse (OpenFIRE exclusive)"},
+        }},
+        {"M3x", "aspect", &OpenFireSettings::aspectMode, nullptr, {
+            {"M3x0", "Fullscreen"},
+            {"M3x1", "4:3 Correction"},
+        }},
+        {"M6x", "rumble", &OpenFireSettings::rumbleMode, nullptr, {
+            {"M6x0", "Disabled (Solenoid allowed)"},
+            {"M6x1", "Enabled (Solenoid disabled, Rumble enabled)"},
+        }},
+        {"M8x", "autoFire", &OpenFireSettings::autoFireMode, nullptr, {
+            {"M8x0", "Disabled (sustained fire is kept enabled in OpenFIRE)"},
+            {"M8x1", "Auto fire on (enables Burst Fire in OpenFIRE)"},
+            {"M8x2", "Auto fire always on rapid fire"},
+        }},
+        {"MDx", "display", &OpenFireSettings::displayMode, nullptr, {
+            {"MDx1", "Life Only"},
+            {"MDx2", "Ammo Only"},
+            {"MDx3", "Life & Ammo Splitscreen"},
+            {"MDx3B", "Life Bar (Life Glyphs otherwise)"},
+        }},
+    };
+    return table;
+}
+
+QList<const OpenFireFlags::Family *> OpenFireFlags::modes()
+{
+    QList<const Family *> result;
+    for (int i = 1; i < families().size(); ++i)
+        result.append(&families().at(i));
+    return result;
+}
+
+// Family of every known flag, keyed by its whole code ("M0x1L").
+static const QHash<QString, const OpenFireFlags::Family *> &familyByCode()
+{
+    static const QHash<QString, const OpenFireFlags::Family *> index = [] {
+        QHash<QString, const OpenFireFlags::Family *> codes;
+        for (const OpenFireFlags::Family &family : OpenFireFlags::families()) {
+            for (const OpenFireFlags::Option &option : family.options)
+                codes.insert(QLatin1String(option.code), &family);
+        }
+        return codes;
+    }();
+    return index;
+}
+
+// Mode family by the word before its value ("M0" for "M0x1").
+static const QHash<QString, const OpenFireFlags::Family *> &modeByWord()
+{
+    static const QHash<QString, const OpenFireFlags::Family *> index = [] {
+        QHash<QString, const OpenFireFlags::Family *> words;
+        for (const OpenFireFlags::Family *family : OpenFireFlags::modes()) {
+            QString word = QLatin1String(family->prefix);
+            word.chop(1);
+            words.insert(word, family);
+        }
+        return words;
+    }();
+    return index;
+}
+
+QStringList OpenFireFlags::itemTexts(const Family &family)
+{
+    QStringList items;
+    if (!family.defaultCode)
+        items << "------";
+    for (const Option &option : family.options)
+        items << QString("%1 - %2").arg(QLatin1String(option.code), QLatin1String(option.description));
+    return items;
+}
+
+int OpenFireFlags::itemIndex(const Family &family, const QString &code)
+{
+    const int offset = family.defaultCode ? 0 : 1;
+    int fallback = 0;
+    for (int i = 0; i < family.options.size(); ++i) {
+        if (code == QLatin1String(family.options.at(i).code))
+            return offset + i;
+        if (family.defaultCode && qstrcmp(family.options.at(i).code, family.defaultCode) == 0)
+            fallback = offset + i;
+    }
+    return fallback;
+}
+
+QString OpenFireFlags::codeAt(const Family &family, int index)
+{
+    const int option = index - (family.defaultCode ? 0 : 1);
+    if (option < 0 || option >= family.options.size())
+        return QString();
+    return QLatin1String(family.options.at(option).code);
+}
+
+void OpenFireFlags::decode(QStringView flags, OpenFireSettings &settings)
+{
+    // "S6xM0x1xM3x1" reads as the words S6 | M0 1 | M3 1
+    const Family *pending = nullptr;
+    qsizetype begin = 0;
+    for (qsizetype i = 0; i <= flags.size(); ++i) {
+        if (i < flags.size() && flags.at(i) != 'x')
+            continue;
+        const QString word = flags.mid(begin, i - begin).toString();
+        begin = i + 1;
+
+        // A mode's value, or a word that is a whole flag (the start command)
+        QString code = word;
+        if (pending)
+            code.prepend(QLatin1String(pending->prefix));
+        const Family *family = familyByCode().value(code);
+        if (family && (pending ? family == pending : family == &start())) {
+            QString &field = settings.*family->field;
+            if (field.isEmpty())
+                field = code;
+        }
+        pending = pending ? nullptr : modeByWord().value(word);
+    }
+}
+
+QString OpenFireFlags::encode(const OpenFireSettings &settings)
+{
+    QStringList flags;
+    for (const Family &family : families()) {
+        if (!(settings.*family.field).isEmpty())
+            flags << settings.*family.field;
+    }
+    return flags.join('x');
+}
+
+bool OpenFireFlags::isModeFlag(QStringView text)
+{
+    const QList<Family> &table = families();
+    for (int i = 1; i < table.size(); ++i) {
+        if (text.startsWith(QLatin1String(table.at(i).prefix)))
+            return true;
+    }
+    return false;
+}
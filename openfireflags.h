@@ -0,0 +1,57 @@
+#ifndef OPENFIREFLAGS_H
+#define OPENFIREFLAGS_H
+
+#include "openfireconfig.h"
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+// The OpenFIRE start and mode flags as data. Each family is one combo on the
+// OpenFIRE tab and one OpenFireSettings field; its options are the values the
+// firmware accepts. MameStart carries them as one compact word, e.g.
+// "S6xM0x1xM3x1": the start flag, then each mode as <family>x<value>, all
+// joined by 'x'. A new firmware flag is a new row in the table.
+class OpenFireFlags
+{
+public:
+    struct Option
+    {
+        const char *code;        // whole flag, e.g. "M0x1L"
+        const char *description;
+        bool selectable = true;  // listed but greyed out in the combo
+    };
+
+    struct Family
+    {
+        const char *prefix;               // "S", "M0x", ... up to the value
+        const char *key;                  // JSON key in layers.json
+        QString OpenFireSettings::*field;
+        const char *defaultCode;          // shown when unset; nullptr shows "------"
+        QList<Option> options;
+    };
+
+    // The start family first, then the modes in modeFlags() order.
+    static const QList<Family> &families();
+    static const Family &start() { return families().first(); }
+    // Everything after start().
+    static QList<const Family *> modes();
+
+    // Combo items: "------" for families without a default, then "<code> - <description>".
+    static QStringList itemTexts(const Family &family);
+    // Item for code; the default (or "------") when code is empty or unknown.
+    static int itemIndex(const Family &family, const QString &code);
+    // Flag at a combo index; empty for "------".
+    static QString codeAt(const Family &family, int index);
+
+    // Fills the unset start and mode fields from a compact flag word. Unknown
+    // flags and values are skipped; the first occurrence of a family wins.
+    static void decode(QStringView flags, OpenFireSettings &settings);
+    // The compact word for the set start and mode fields.
+    static QString encode(const OpenFireSettings &settings);
+
+    // True when text begins with one of the mode prefixes ("M0x", ...).
+    static bool isModeFlag(QStringView text);
+};
+
+#endif // OPENFIREFLAGS_H
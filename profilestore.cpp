@@ -0,0 +1,86 @@
+#include "profilestore.h"
+#include "dsqlogging.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+ProfileStore::ProfileStore(const QString &settingsPath)
+    : directory(QFileInfo(settingsPath).absoluteDir().filePath("profiles"))
+{
+}
+
+QString ProfileStore::filePath(const QString &romCode) const
+{
+    // ROM codes are plain identifiers, but keep anything odd out of the path
+    QString name = romCode;
+    for (QChar &ch : name) {
+        if (!ch.isLetterOrNumber() && ch != '_' && ch != '-')
+            ch = '_';
+    }
+    return directory + '/' + name + ".json";
+}
+
+QJsonObject ProfileStore::profile(const QString &romCode)
+{
+    if (romCode.isEmpty())
+        return QJsonObject();
+
+    auto cached = cache.constFind(romCode);
+    if (cached != cache.constEnd())
+        return cached.value();
+
+    QJsonObject values;
+    QFile file(filePath(romCode));
+    if (file.open(QIODevice::ReadOnly)) {
+        QJsonParseError error;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+        if (error.error == QJsonParseError::NoError && document.isObject())
+            values = document.object();
+        else
+            qCWarning(lcIni) << "Ignoring unreadable profile" << file.fileName() << error.errorString();
+    }
+    cache.insert(romCode, values);
+    return values;
+}
+
+QJsonObject ProfileStore::profileOrDefault(const QString &romCode)
+{
+    const QJsonObject values = profile(romCode);
+    return values.isEmpty() ? defaultProfile() : values;
+}
+
+void ProfileStore::setProfile(const QString &romCode, const QJsonObject &values)
+{
+    if (romCode.isEmpty() || profile(romCode) == values)
+        return;
+    cache.insert(romCode, values);
+    dirty.insert(romCode);
+}
+
+bool ProfileStore::flush()
+{
+    if (dirty.isEmpty())
+        return true;
+    if (!QDir().mkpath(directory)) {
+        qCWarning(lcIni) << "Failed to create profile directory:" << directory;
+        return false;
+    }
+
+    bool ok = true;
+    const QSet<QString> pending = dirty;
+    for (const QString &romCode : pending) {
+        // QSaveFile leaves the previous profile intact if we die mid-write
+        QSaveFile file(filePath(romCode));
+        if (file.open(QIODevice::WriteOnly)
+            && file.write(QJsonDocument(cache.value(romCode)).toJson(QJsonDocument::Compact)) >= 0
+            && file.commit()) {
+            dirty.remove(romCode);
+        } else {
+            qCWarning(lcIni) << "Failed to save profile:" << file.fileName();
+            ok = false;
+        }
+    }
+    return ok;
+}
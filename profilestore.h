@@ -0,0 +1,44 @@
+#ifndef PROFILESTORE_H
+#define PROFILESTORE_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+
+// Per-game output choices (colour and output combo indexes, output texts),
+// one small JSON file per ROM code in a profiles folder next to
+// settings.ini. A profile is read from disk the first time its game is
+// selected and cached after that, so the number of saved games costs
+// nothing at startup. Changes are kept in memory until flush(), which
+// rewrites only the changed profiles, each through QSaveFile.
+class ProfileStore
+{
+public:
+    explicit ProfileStore(const QString &settingsPath);
+
+    // Empty when nothing was saved for romCode.
+    QJsonObject profile(const QString &romCode);
+    void setProfile(const QString &romCode, const QJsonObject &values);
+
+    // Used for games with no profile of their own; holds the one set of
+    // output choices older versions kept in settings.ini.
+    QJsonObject defaultProfile() { return profile(defaultKey()); }
+    void setDefaultProfile(const QJsonObject &values) { setProfile(defaultKey(), values); }
+    // romCode's profile, or the default one when nothing was saved for it.
+    QJsonObject profileOrDefault(const QString &romCode);
+
+    bool hasPendingChanges() const { return !dirty.isEmpty(); }
+    bool flush();
+
+private:
+    // No catalog ROM code starts with an underscore, so this never clashes.
+    static QString defaultKey() { return QStringLiteral("_default"); }
+    QString filePath(const QString &romCode) const;
+
+    QString directory;
+    QHash<QString, QJsonObject> cache;
+    QSet<QString> dirty;
+};
+
+#endif // PROFILESTORE_H
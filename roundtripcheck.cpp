@@ -0,0 +1,240 @@
+#include "roundtripcheck.h"
+#include "bulkedit.h"
+#include "emulatorutils.h"
+#include "inidocument.h"
+#include "openfireconfig.h"
+#include "openfireflags.h"
+#include "textfile.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+
+RoundTripCheck::RoundTripCheck(const QString &goldenDir, int timeLimitMs, bool updateGolden)
+    : goldenDir(goldenDir),
+      timeLimitMs(timeLimitMs),
+      updateGolden(updateGolden)
+{
+}
+
+static const LedColor modifiedColor = {255, 0, 0};
+static const char modifiedRecoil[] = "F0x%s%";
+static const char bulkStart[] = "S2";
+static const char bulkAspect[] = "M3x0";
+
+QString RoundTripCheck::roundTrip(const QString &iniContent)
+{
+    return OpenFireConfig::apply(iniContent, OpenFireConfig::parse(iniContent));
+}
+
+QString RoundTripCheck::modify(const QString &iniContent, const OpenFireSettings &settings)
+{
+    QString modified = OpenFireConfig::setLmpStart(iniContent, 1, modifiedColor);
+    if (settings.hasOutput("CtmRecoil"))
+        modified = OpenFireConfig::setOutputForAllPlayers(modified, "CtmRecoil", modifiedRecoil);
+    return modified;
+}
+
+// Lines apply() may change: MameStart and the standalone mode flags it
+// folds into it.
+static bool isRewrittenLine(const QString &line)
+{
+    const QString trimmed = line.trimmed();
+    return trimmed.startsWith(QLatin1String("MameStart")) || OpenFireFlags::isModeFlag(trimmed);
+}
+
+// Lines modify() may change: P1's LED colour and the recoil lines.
+static bool isModifiedLine(const QString &line)
+{
+    return line.startsWith(QLatin1String("P1_LmpStart"))
+        || (line.size() > 3 && line.at(0) == 'P' && line.mid(2).startsWith(QLatin1String("_CtmRecoil")));
+}
+
+// Lines of before missing from after and lines of after that were not in
+// before, counting repeats; lines allowed() claims may come and go.
+template <typename Allowed>
+static QStringList changedLines(const QString &before, const QString &after, Allowed allowed)
+{
+    QHash<QString, int> balance;
+    for (const QString &line : before.split('\n'))
+        ++balance[line];
+    for (const QString &line : after.split('\n'))
+        --balance[line];
+
+    QStringList problems;
+    for (auto it = balance.cbegin(); it != balance.cend(); ++it) {
+        if (it.value() == 0 || allowed(it.key()))
+            continue;
+        const QString what = it.value() > 0 ? "lost line: " : "added line: ";
+        for (int i = 0; i < qAbs(it.value()); ++i)
+            problems << what + it.key().trimmed();
+    }
+    problems.sort();
+    return problems;
+}
+
+// Every "<key> = <value>" of [Output] by key ("P2_Damaged", "Credits"); the
+// first line wins for a repeated key.
+static QMap<QString, QString> outputValues(const QString &iniContent)
+{
+    QMap<QString, QString> values;
+    const IniDocument doc(iniContent);
+    int begin, end;
+    if (!doc.sectionRange("Output", begin, end))
+        return values;
+    for (int i = begin; i < end; ++i) {
+        const QString &line = doc.line(i);
+        const int eq = line.indexOf('=');
+        const QString key = line.left(eq).trimmed();
+        if (eq > 0 && !values.contains(key))
+            values.insert(key, line.mid(eq + 1).trimmed());
+    }
+    return values;
+}
+
+static QStringList compareOutputs(const QMap<QString, QString> &expected, const QMap<QString, QString> &actual)
+{
+    QStringList problems;
+    for (auto it = expected.cbegin(); it != expected.cend(); ++it) {
+        if (!actual.contains(it.key()))
+            problems << it.key() + " removed";
+        else if (actual.value(it.key()) != it.value())
+            problems << QString("%1: %2 -> %3").arg(it.key(), it.value(), actual.value(it.key()));
+    }
+    for (auto it = actual.cbegin(); it != actual.cend(); ++it) {
+        if (!expected.contains(it.key()))
+            problems << it.key() + " added";
+    }
+    return problems;
+}
+
+static QStringList compareSettings(const OpenFireSettings &before, const OpenFireSettings &after)
+{
+    QStringList problems;
+    if (before.startCommand != after.startCommand)
+        problems << QString("start command %1 -> %2").arg(before.startCommand, after.startCommand);
+    if (before.modeFlags() != after.modeFlags())
+        problems << QString("mode flags %1 -> %2").arg(before.modeFlags().join('x'), after.modeFlags().join('x'));
+    if (before.playerCount != after.playerCount)
+        problems << QString("player count %1 -> %2").arg(before.playerCount).arg(after.playerCount);
+    if (before.presentSettings != after.presentSettings)
+        problems << "set of output keys changed";
+    if (before.outputs != after.outputs)
+        problems << "output values changed";
+    for (int i = 0; i < 4; ++i) {
+        const LedColor &a = before.ledColors[i];
+        const LedColor &b = after.ledColors[i];
+        if (a.red != b.red || a.green != b.green || a.blue != b.blue)
+            problems << QString("P%1 LED colour changed").arg(i + 1);
+    }
+    return problems;
+}
+
+RoundTripCheck::FileResult RoundTripCheck::checkFile(const QString &iniPath)
+{
+    FileResult result;
+    result.fileName = QFileInfo(iniPath).fileName();
+
+    // Loaded as EmulatorUtils::loadIniContent() does, keeping the format for the golden copy
+    QString original;
+    TextFormat format;
+    TextFile::read(iniPath, original, &format);
+    if (!original.contains("[General]"))
+        original.prepend(EmulatorUtils::defaultIniHeader());
+
+    QElapsedTimer timer;
+    timer.start();
+    const OpenFireSettings before = OpenFireConfig::parse(original);
+    const QString serialized = OpenFireConfig::apply(original, before);
+    const OpenFireSettings after = OpenFireConfig::parse(serialized);
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+
+    result.problems << compareSettings(before, after);
+    result.problems << compareOutputs(outputValues(original), outputValues(serialized));
+    result.problems << changedLines(original, serialized, isRewrittenLine);
+
+    // The edit must show up, and change nothing else
+    const QString modified = modify(serialized, after);
+    const OpenFireSettings edited = OpenFireConfig::parse(modified);
+    OpenFireSettings expected = after;
+    expected.ledColors[0] = modifiedColor;
+    QMap<QString, QString> expectedOutputs = outputValues(serialized);
+    const QString ledLine = OpenFireConfig::lmpStartLine(1, modifiedColor);
+    expectedOutputs.insert("P1_LmpStart", ledLine.mid(ledLine.indexOf('=') + 1).trimmed());
+    if (after.hasOutput("CtmRecoil")) {
+        for (auto &output : expected.outputs) {
+            if (output.first == "CtmRecoil")
+                output.second = modifiedRecoil;
+        }
+        for (int player = 1; player <= 4; ++player) {
+            const QString key = QString("P%1_CtmRecoil").arg(player);
+            if (expectedOutputs.contains(key))
+                expectedOutputs.insert(key, QString("cmw %1 %2").arg(player).arg(modifiedRecoil));
+        }
+    }
+    expected.presentSettings.insert("LmpStart");
+    // A file without [Output] gets the section, after a blank line
+    const bool addsOutput = !serialized.contains("[Output]");
+    // ...which makes parse() count the players MameStart talks to
+    if (addsOutput)
+        expected.playerCount = edited.playerCount;
+    auto editedLine = [addsOutput](const QString &line) {
+        return isModifiedLine(line) || (addsOutput && (line.isEmpty() || line == "[Output]"));
+    };
+    for (const QString &problem : compareSettings(expected, edited))
+        result.problems << "after edit: " + problem;
+    for (const QString &problem : compareOutputs(expectedOutputs, outputValues(modified)))
+        result.problems << "after edit: " + problem;
+    for (const QString &problem : changedLines(serialized, modified, editedLine))
+        result.problems << "after edit: " + problem;
+
+    // A bulk edit of the start and mode flags changes MameStart and nothing else
+    if (!after.startCommand.isEmpty()) {
+        OpenFireSettings flagChanges;
+        flagChanges.startCommand = bulkStart;
+        flagChanges.aspectMode = bulkAspect;
+        const QString bulk = BulkEdit::transform(serialized, flagChanges);
+        OpenFireSettings expectedBulk = after;
+        expectedBulk.startCommand = bulkStart;
+        expectedBulk.aspectMode = bulkAspect;
+        for (const QString &problem : compareSettings(expectedBulk, OpenFireConfig::parse(bulk)))
+            result.problems << "after bulk edit: " + problem;
+        for (const QString &problem : compareOutputs(outputValues(serialized), outputValues(bulk)))
+            result.problems << "after bulk edit: " + problem;
+        for (const QString &problem : changedLines(serialized, bulk, isRewrittenLine))
+            result.problems << "after bulk edit: " + problem;
+    }
+
+    if (timeLimitMs > 0 && result.elapsedUs > qint64(timeLimitMs) * 1000)
+        result.problems << QString("took %1 ms (limit %2 ms)").arg(result.elapsedUs / 1000.0, 0, 'f', 1).arg(timeLimitMs);
+
+    if (!goldenDir.isEmpty()) {
+        const QString goldenPath = QDir(goldenDir).filePath(result.fileName);
+        const QByteArray output = TextFile::encode(modified, format);
+        if (updateGolden) {
+            QDir().mkpath(goldenDir);
+            QFile golden(goldenPath);
+            if (!golden.open(QIODevice::WriteOnly | QIODevice::Truncate) || golden.write(output) != output.size())
+                result.problems << "cannot write golden file";
+        } else {
+            QFile golden(goldenPath);
+            if (!golden.open(QIODevice::ReadOnly))
+                result.problems << "no golden file";
+            else if (golden.readAll() != output)
+                result.problems << "differs from golden output";
+        }
+    }
+
+    return result;
+}
+
+QList<RoundTripCheck::FileResult> RoundTripCheck::checkDirectory(const QString &iniDir)
+{
+    QList<FileResult> results;
+    const QDir dir(iniDir);
+    for (const QString &name : dir.entryList({"*.ini"}, QDir::Files, QDir::Name))
+        results.append(checkFile(dir.filePath(name)));
+    return results;
+}
@@ -0,0 +1,169 @@
+#include "textfile.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+// Strict enough to tell UTF-8 from a Windows code page; a sequence cut
+// off by the end of the data counts as invalid.
+static bool isValidUtf8(const QByteArray &data)
+{
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data.constData());
+    const int size = int(data.size());
+    for (int i = 0; i < size; ) {
+        const unsigned char lead = bytes[i];
+        int continuation;
+        if (lead < 0x80)
+            continuation = 0;
+        else if (lead >= 0xC2 && lead <= 0xDF)
+            continuation = 1;
+        else if (lead >= 0xE0 && lead <= 0xEF)
+            continuation = 2;
+        else if (lead >= 0xF0 && lead <= 0xF4)
+            continuation = 3;
+        else
+            return false;
+        if (i + continuation >= size)
+            return false;
+        for (int j = 1; j <= continuation; ++j) {
+            if ((bytes[i + j] & 0xC0) != 0x80)
+                return false;
+        }
+        i += continuation + 1;
+    }
+    return true;
+}
+
+TextFormat TextFile::defaultFormat()
+{
+    TextFormat format;
+#ifdef Q_OS_WIN
+    format.crlf = true;
+#endif
+    return format;
+}
+
+QString TextFile::decode(const QByteArray &data, TextFormat *format)
+{
+    TextFormat detected = defaultFormat();
+    QString text;
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    if (data.startsWith("\xEF\xBB\xBF")) {
+        detected.byteOrderMark = true;
+        text = QString::fromUtf8(data.constData() + 3, int(data.size()) - 3);
+    } else if (data.size() >= 2 && (data.startsWith("\xFF\xFE") || data.startsWith("\xFE\xFF"))) {
+        const bool little = bytes[0] == 0xFF;
+        detected.encoding = little ? TextFormat::Encoding::Utf16LE : TextFormat::Encoding::Utf16BE;
+        detected.byteOrderMark = true;
+        const int units = int(data.size() - 2) / 2;
+        text.resize(units);
+        QChar *out = text.data();
+        for (int i = 0; i < units; ++i) {
+            const uchar *unit = bytes + 2 + 2 * i;
+            out[i] = QChar(little ? qFromLittleEndian<quint16>(unit) : qFromBigEndian<quint16>(unit));
+        }
+    } else if (isValidUtf8(data)) {
+        text = QString::fromUtf8(data);
+    } else {
+        detected.encoding = TextFormat::Encoding::Local8Bit;
+        text = QString::fromLocal8Bit(data);
+    }
+
+    // The first line break decides how the file is written back
+    const int firstBreak = int(text.indexOf('\n'));
+    if (firstBreak >= 0)
+        detected.crlf = firstBreak > 0 && text.at(firstBreak - 1) == '\r';
+    if (text.contains('\r'))
+        text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+
+    if (format)
+        *format = detected;
+    return text;
+}
+
+QByteArray TextFile::encode(const QString &text, const TextFormat &format)
+{
+    QString lines = text;
+    if (lines.contains('\r'))
+        lines.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+    if (format.crlf)
+        lines.replace('\n', QLatin1String("\r\n"));
+
+    QByteArray data;
+    switch (format.encoding) {
+    case TextFormat::Encoding::Utf8:
+        if (format.byteOrderMark)
+            data = "\xEF\xBB\xBF";
+        data += lines.toUtf8();
+        break;
+    case TextFormat::Encoding::Utf16LE:
+    case TextFormat::Encoding::Utf16BE: {
+        const bool little = format.encoding == TextFormat::Encoding::Utf16LE;
+        data.resize(2 + 2 * lines.size());
+        uchar *out = reinterpret_cast<uchar *>(data.data());
+        // A BOM is how the file was recognised, so UTF-16 always gets one
+        if (little)
+            qToLittleEndian<quint16>(0xFEFF, out);
+        else
+            qToBigEndian<quint16>(0xFEFF, out);
+        for (int i = 0; i < lines.size(); ++i) {
+            if (little)
+                qToLittleEndian<quint16>(lines.at(i).unicode(), out + 2 + 2 * i);
+            else
+                qToBigEndian<quint16>(lines.at(i).unicode(), out + 2 + 2 * i);
+        }
+        break;
+    }
+    case TextFormat::Encoding::Local8Bit:
+        data = lines.toLocal8Bit();
+        break;
+    }
+    return data;
+}
+
+bool TextFile::read(const QString &path, QString &text, TextFormat *format)
+{
+    text.clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (format)
+            *format = defaultFormat();
+        return false;
+    }
+    text = decode(file.readAll(), format);
+    return true;
+}
+
+bool TextFile::write(const QString &path, const QString &text, const TextFormat &format)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(encode(text, format));
+    return file.commit();
+}
+
+bool TextFile::write(const QString &path, const QString &text)
+{
+    TextFormat format = defaultFormat();
+    QFile existing(path);
+    if (existing.open(QIODevice::ReadOnly)) {
+        decode(existing.readAll(), &format);
+        existing.close();
+    }
+    return write(path, text, format);
+}
+
+QStringView LineReader::next()
+{
+    const qsizetype start = position;
+    qsizetype end = start;
+    while (end < text.size() && text.at(end) != '\n')
+        ++end;
+    position = end + 1;
+
+    QStringView line = text.mid(start, end - start);
+    if (line.endsWith('\r'))
+        line.chop(1);
+    return line;
+}
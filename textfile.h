@@ -0,0 +1,61 @@
+#ifndef TEXTFILE_H
+#define TEXTFILE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+
+// How a text file is stored on disk: encoding, byte order mark and line
+// ending. Recorded on read so a write gives the same bytes back for the
+// lines that did not change.
+struct TextFormat
+{
+    enum class Encoding { Utf8, Utf16LE, Utf16BE, Local8Bit };
+
+    Encoding encoding = Encoding::Utf8;
+    bool byteOrderMark = false;
+    bool crlf = false;
+
+    bool operator==(const TextFormat &other) const
+    {
+        return encoding == other.encoding && byteOrderMark == other.byteOrderMark && crlf == other.crlf;
+    }
+};
+
+// Reads and writes the ini and bat files. Text is handed out with '\n'
+// line ends; UTF-8 (with or without BOM), UTF-16 with a BOM and, for files
+// that are not valid UTF-8, the local 8-bit code page are recognised.
+class TextFile
+{
+public:
+    // UTF-8 without BOM; CRLF on Windows.
+    static TextFormat defaultFormat();
+
+    // Empty text and false when the file cannot be read.
+    static bool read(const QString &path, QString &text, TextFormat *format = nullptr);
+    static QString decode(const QByteArray &data, TextFormat *format = nullptr);
+    static QByteArray encode(const QString &text, const TextFormat &format);
+
+    // Atomic write in format.
+    static bool write(const QString &path, const QString &text, const TextFormat &format);
+    // Atomic write in the format of the file already at path, or
+    // defaultFormat() for a new file.
+    static bool write(const QString &path, const QString &text);
+};
+
+// The '\n'-separated lines of a text as views into it, without copying;
+// a trailing '\r' is dropped. Yields the same lines as split('\n').
+class LineReader
+{
+public:
+    explicit LineReader(QStringView text) : text(text) {}
+
+    bool atEnd() const { return position > text.size(); }
+    QStringView next();
+
+private:
+    QStringView text;
+    qsizetype position = 0;
+};
+
+#endif // TEXTFILE_H
@@ -0,0 +1,203 @@
+#include "uilatencyharness.h"
+#include "configbench.h"
+#include "emulatorutils.h"
+#include "mainwindow.h"
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QTabWidget>
+#include <QTemporaryDir>
+#include <QTextEdit>
+#include <QTextStream>
+
+// Per-step budgets in milliseconds before scaling.
+static const int selectEmulatorBudgetMs = 250;
+static const int selectGameBudgetMs = 150;
+static const int comboBudgetMs = 50;
+static const int typingBudgetMs = 100;
+static const int exportBudgetMs = 200;
+static const int refreshBudgetMs = 150;
+
+UiLatencyHarness::UiLatencyHarness(double budgetScale)
+    : budgetScale(budgetScale > 0 ? budgetScale : 1.0)
+{
+}
+
+void UiLatencyHarness::step(MainWindow &window, const QString &name, int budgetMs,
+                            const std::function<void()> &action)
+{
+    window.resetCallCounters();
+
+    QElapsedTimer timer;
+    timer.start();
+    action();
+    // Include whatever the action queued (highlighting, deferred updates).
+    QCoreApplication::processEvents();
+
+    Step result;
+    result.name = name;
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    result.budgetUs = qint64(budgetMs * budgetScale * 1000);
+    result.updateIniText = window.callCounters().updateIniText;
+    result.iniRegenerations = window.callCounters().iniRegenerations;
+    result.loadIniSettings = window.callCounters().loadIniSettings;
+    result.setPlainText = window.callCounters().setPlainText;
+    recorded.append(result);
+}
+
+bool UiLatencyHarness::run(const QString &emulator)
+{
+    recorded.clear();
+
+    const QStringList games = EmulatorUtils::gamesForEmulator(emulator);
+    if (games.isEmpty()) {
+        qWarning() << "Unknown emulator for the latency harness:" << emulator;
+        return false;
+    }
+
+    // Scratch QMamehook tree with a two-player ini for every game.
+    QTemporaryDir scratch;
+    if (!scratch.isValid()) {
+        qWarning() << "Cannot create a scratch directory for the latency harness";
+        return false;
+    }
+    QDir hookDir(scratch.path());
+    hookDir.mkpath("ini");
+    hookDir.mkpath("bat");
+    const QByteArray ini = ConfigBench::syntheticIni(2, 0).toUtf8();
+    for (const QString &game : games) {
+        QFile file(hookDir.filePath("ini/" + EmulatorUtils::mapRom(game) + ".ini"));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+            file.write(ini);
+    }
+
+    MainWindow window(nullptr, hookDir.filePath("settings.ini"));
+    window.show();
+    QCoreApplication::processEvents();
+    window.completeStartup();
+
+    // The OpenFIRE widgets only exist once their tab has been opened.
+    QTabWidget *tabs = window.findChild<QTabWidget *>("tabWidget_Advanced");
+    QWidget *openFireTab = window.findChild<QWidget *>("tab_OpenFIRE");
+    if (tabs && openFireTab)
+        tabs->setCurrentWidget(openFireTab);
+
+    QComboBox *emulatorBox = window.findChild<QComboBox *>("emulatorComboBox");
+    QComboBox *romBox = window.findChild<QComboBox *>("romComboBox");
+    QComboBox *recoilBox = window.findChild<QComboBox *>("Recoil");
+    QComboBox *colorBox = window.findChild<QComboBox *>("P1Color");
+    QTextEdit *recoilText = window.findChild<QTextEdit *>("Recoil_Text");
+    QLineEdit *hookPathEdit = window.findChild<QLineEdit *>("qmamehookerPathLineEdit");
+    if (!emulatorBox || !romBox || !recoilBox || !colorBox || !recoilText || !hookPathEdit) {
+        qWarning() << "MainWindow is missing a widget the latency harness drives";
+        return false;
+    }
+
+    // Start from a different emulator so selecting ours emits the usual signals.
+    if (emulatorBox->currentText() == emulator) {
+        for (int i = 0; i < emulatorBox->count(); ++i) {
+            const QString entry = emulatorBox->itemText(i);
+            if (entry != emulator && !EmulatorUtils::isDivider(entry)) {
+                emulatorBox->setCurrentIndex(i);
+                break;
+            }
+        }
+    }
+    hookPathEdit->setText(hookDir.path());
+
+    step(window, "select emulator", selectEmulatorBudgetMs, [&]() {
+        emulatorBox->setCurrentText(emulator);
+    });
+
+    // Changing emulator may reset the QMamehook path to the platform default.
+    hookPathEdit->setText(hookDir.path());
+
+    // Every game once, ending back on the first.
+    for (int i = 1; i <= romBox->count(); ++i) {
+        const int index = i % romBox->count();
+        step(window, "select game: " + romBox->itemText(index), selectGameBudgetMs, [&]() {
+            romBox->setCurrentIndex(index);
+        });
+    }
+
+    step(window, "change recoil", comboBudgetMs, [&]() {
+        recoilBox->setCurrentText(recoilBox->currentText() == "Rumble Switching"
+                                      ? "Solenoid Switching" : "Rumble Switching");
+    });
+
+    step(window, "change colour", comboBudgetMs, [&]() {
+        colorBox->setCurrentIndex((colorBox->currentIndex() + 1) % qMax(1, colorBox->count()));
+    });
+
+    recoilText->clear();
+    QCoreApplication::processEvents();
+    step(window, "type custom text", typingBudgetMs, [&]() {
+        // One keystroke at a time, like a user typing.
+        for (const QChar ch : QString("F0x3x1")) {
+            recoilText->textCursor().insertText(QString(ch));
+            QCoreApplication::processEvents();
+        }
+    });
+
+    step(window, "export", exportBudgetMs, [&]() {
+        bool exported = false;
+        QMetaObject::invokeMethod(&window, "exportFiles", Qt::DirectConnection,
+                                  Q_RETURN_ARG(bool, exported), Q_ARG(bool, false));
+    });
+
+    step(window, "refresh", refreshBudgetMs, [&]() {
+        QMetaObject::invokeMethod(&window, "refreshIni", Qt::DirectConnection);
+    });
+
+    window.close();
+
+    for (const Step &result : recorded) {
+        if (result.overBudget())
+            return false;
+    }
+    return true;
+}
+
+void UiLatencyHarness::writeReport(QTextStream &out) const
+{
+    out << "step\tms\tbudget_ms\tupdateIniText\tregenerations\tloadIniSettings\tsetPlainText\n";
+    for (const Step &result : recorded) {
+        out << result.name << '\t'
+            << QString::number(result.elapsedUs / 1000.0, 'f', 2) << '\t'
+            << QString::number(result.budgetUs / 1000.0, 'f', 0) << '\t'
+            << result.updateIniText << '\t'
+            << result.iniRegenerations << '\t'
+            << result.loadIniSettings << '\t'
+            << result.setPlainText
+            << (result.overBudget() ? "\tOVER BUDGET" : "") << '\n';
+    }
+}
+
+QByteArray UiLatencyHarness::toJson() const
+{
+    QJsonArray steps;
+    for (const Step &result : recorded) {
+        QJsonObject entry;
+        entry["name"] = result.name;
+        entry["elapsedUs"] = double(result.elapsedUs);
+        entry["budgetUs"] = double(result.budgetUs);
+        entry["updateIniText"] = result.updateIniText;
+        entry["iniRegenerations"] = result.iniRegenerations;
+        entry["loadIniSettings"] = result.loadIniSettings;
+        entry["setPlainText"] = result.setPlainText;
+        entry["overBudget"] = result.overBudget();
+        steps.append(entry);
+    }
+
+    QJsonObject root;
+    root["qtVersion"] = QString::fromLatin1(qVersion());
+    root["steps"] = steps;
+    return QJsonDocument(root).toJson();
+}
@@ -0,0 +1,47 @@
+#ifndef UILATENCYHARNESS_H
+#define UILATENCYHARNESS_H
+
+#include <QList>
+#include <QString>
+#include <functional>
+
+class MainWindow;
+class QTextStream;
+
+// Drives a real MainWindow through the everyday flows (pick emulator, pick
+// each game, change combos, type custom text, export, refresh) and records
+// wall time plus how often updateIniText ran (and actually regenerated the
+// ini), loadIniSettings and the editor's setPlainText ran for each step. A step fails when it exceeds its budget.
+// Runs against a scratch QMamehook directory and settings file.
+class UiLatencyHarness
+{
+public:
+    struct Step
+    {
+        QString name;
+        qint64 elapsedUs = 0;
+        qint64 budgetUs = 0;
+        int updateIniText = 0;
+        int iniRegenerations = 0;
+        int loadIniSettings = 0;
+        int setPlainText = 0;
+        bool overBudget() const { return elapsedUs > budgetUs; }
+    };
+
+    explicit UiLatencyHarness(double budgetScale = 1.0);
+
+    // Returns false when any step went over budget (or the flow could not run).
+    bool run(const QString &emulator);
+
+    const QList<Step> &steps() const { return recorded; }
+    void writeReport(QTextStream &out) const;
+    QByteArray toJson() const;
+
+private:
+    void step(MainWindow &window, const QString &name, int budgetMs, const std::function<void()> &action);
+
+    double budgetScale;
+    QList<Step> recorded;
+};
+
+#endif // UILATENCYHARNESS_H
@@ -0,0 +1,47 @@
+#include "uilatencyharness.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+
+// dsq_ui_latency: drives MainWindow offscreen and fails when a step is over budget.
+int main(int argc, char *argv[])
+{
+    // A real window, rendered offscreen unless a platform was chosen.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures DemulEASY's main window through its everyday flows.");
+    parser.addHelpOption();
+    QCommandLineOption budgetScaleOption("budget-scale", "Multiply the step budgets by <factor>.", "factor", "1");
+    QCommandLineOption outputOption("output", "Also write the steps to <file> as JSON.", "file");
+    parser.addOptions({budgetScaleOption, outputOption});
+    parser.addPositionalArgument("emulator", "Friendly emulator name (default: \"Demul 0.7a\").");
+    parser.process(app);
+
+    const QString emulator = parser.positionalArguments().value(0, "Demul 0.7a");
+    UiLatencyHarness harness(parser.value(budgetScaleOption).toDouble());
+    const bool withinBudget = harness.run(emulator);
+    if (harness.steps().isEmpty())
+        return 2;
+
+    harness.writeReport(out);
+
+    const QString outputPath = parser.value(outputOption);
+    if (!outputPath.isEmpty()) {
+        QFile file(outputPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err << "Cannot write " << outputPath << '\n';
+            return 1;
+        }
+        file.write(harness.toJson());
+    }
+
+    if (!withinBudget)
+        err << "One or more steps exceeded their latency budget\n";
+    return withinBudget ? 0 : 1;
+}